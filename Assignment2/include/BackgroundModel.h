@@ -0,0 +1,67 @@
+/*
+ * BackgroundModel.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef BACKGROUNDMODEL_H_
+#define BACKGROUNDMODEL_H_
+
+#include "opencv2/opencv.hpp"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Adaptive per-pixel background model in HSV-color space
+ *
+ * A channel of a pixel differs from the background if its distance is larger than the
+ * channel threshold (and, for the statistical models, larger than the expected noise).
+ * The pixel is foreground if (H AND S) OR V differ, like the static background model.
+ * The model state is kept in fixed point and only updated when learning.
+ */
+class BackgroundModel
+{
+public:
+	enum Type
+	{
+		STATIC = 0, RUNNING_AVERAGE, GAUSSIAN, MIXTURE, TYPES_AMOUNT
+	};
+
+protected:
+	const Type _type;
+	const cv::Size _size;
+
+	// Learning rate alpha = 1 / 2^_learning_shift
+	int _learning_shift;
+
+	BackgroundModel(Type, const cv::Size &);
+
+public:
+	virtual ~BackgroundModel();
+
+	static BackgroundModel* create(Type, const cv::Mat &);
+	static std::string getTypeName(Type);
+
+	virtual void apply(const cv::Mat &, int, int, int, bool, cv::Mat &) = 0;
+	virtual void getBackground(cv::Mat &) const = 0;
+
+	Type getType() const
+	{
+		return _type;
+	}
+
+	int getLearningShift() const
+	{
+		return _learning_shift;
+	}
+
+	void setLearningShift(int learningShift)
+	{
+		_learning_shift = learningShift;
+	}
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* BACKGROUNDMODEL_H_ */
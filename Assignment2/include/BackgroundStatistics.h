@@ -0,0 +1,41 @@
+/*
+ * BackgroundStatistics.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef BACKGROUNDSTATISTICS_H_
+#define BACKGROUNDSTATISTICS_H_
+
+#include <stdint.h>
+#include <string>
+
+#include "opencv2/opencv.hpp"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Per-pixel statistics of a background video in HSV-color space: the mean and standard
+ * deviation of every channel over all the video's frames (circular for hue), and the BGR mean
+ *
+ * Building them streams the whole video once, after that they're read from a small binary
+ * file (next to the camera's other files), which is rebuilt when the video changes (another
+ * size, modification time or first frame).
+ */
+class BackgroundStatistics
+{
+	static const uint32_t MAGIC;
+	static const int32_t VERSION;
+
+public:
+	static bool obtain(const std::string &, const std::string &, cv::Mat &, cv::Mat &, cv::Mat &);
+	static bool build(const std::string &, cv::Mat &, cv::Mat &, cv::Mat &, int &, uint64_t &);
+	static bool load(const std::string &, const std::string &, int64_t, int64_t, cv::Mat &, cv::Mat &, cv::Mat &);
+	static bool save(const std::string &, int64_t, int64_t, uint64_t, int, const cv::Mat &, const cv::Mat &,
+			const cv::Mat &);
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* BACKGROUNDSTATISTICS_H_ */
@@ -11,15 +11,64 @@
 #include "opencv2/opencv.hpp"
 
 #include "General.h"
+#include "Morphology.h"
+#include "GraphCut.h"
 
 namespace nl_uu_science_gmt
 {
 
+class BackgroundModel;
+class FramePrefetcher;
+class FrameStore;
+class SharedFrameRing;
+class SeekIndex;
+
 #define MAIN_WINDOW "Checkerboard Marking"
 
 class Camera
 {
+public:
+	/**
+	 * Intermediate buffers of this camera's per-frame processing. They are (re)allocated only
+	 * when their size or type changes, so after the first frame the loop reuses the same memory.
+	 */
+	struct Workspace
+	{
+		cv::Mat hsv_frame;        // HSV frame written by the fused subtraction kernel
+		cv::Mat subtraction;      // raw background subtraction mask
+		cv::Mat morphology;       // intermediate (eroded) mask
+		cv::Mat foreground;       // final foreground mask, shared with _foreground_image
+		cv::Mat integral;         // integral image of the foreground mask, for footprint carving
+		cv::Mat background;       // HSV background of an adaptive model, for the graph cut data terms
+		cv::Mat foreground_bgr;   // foreground mask as BGR, for display
+		cv::Mat canvas;           // frame and foreground side by side, for display
+		cv::Mat difference;       // per channel |HSV - background HSV| of the current frame
+		bool difference_valid;    // difference belongs to the current frame (reset when advancing)
+		PackedMask packed_subtraction;  // 1-bit versions of the masks above, for packed masks
+		PackedMask packed_morphology;
+		PackedMask packed_foreground;
+		Morphology filter;        // erosion/dilation with its own scratch buffers
+		GraphCut graph_cut;       // band-limited graph cut, keeps its graph between frames
+		std::vector<unsigned int> sparse_memo;  // memoized subtraction of the sparse evaluation
+		unsigned int sparse_generation;
+		bool sparse_mask;         // foreground holds a sparse mask (0 outside the referenced pixels)
+
+		size_t reallocations;     // buffers that moved after their first allocation, see track()
+		std::vector<const uchar*> buffers;
+
+		Workspace() :
+				difference_valid(false), sparse_generation(0), sparse_mask(false), reallocations(0)
+		{
+		}
+
+		void track();
+	};
+
+private:
 	static std::vector<cv::Point>* _BoardCorners;  // marked checkerboard corners
+	static const size_t PREFETCH_FRAMES = 4;        // frames decoded ahead of the processing
+	static const int RING_TIMEOUT = 1000;           // ms to wait for a frame from the shared memory
+	static const int RING_WAIT = 100;               // times 100 ms to wait for the producer on start-up
 
 	bool _initialized;
 
@@ -28,12 +77,26 @@ class Camera
 	const int _id;
 
 	std::vector<cv::Mat> _bg_hsv_channels;
+	cv::Mat _bg_hsv_image;  // interleaved background HSV, for the fused subtraction kernel
+	cv::Mat _bg_hsv_deviation;  // per pixel expected HSV noise (2.5 standard deviations), 0 if unknown
+	cv::Mat _bg_ycrcb_image;  // interleaved background YCrCb, for the YCrCb subtraction kernel
+	BackgroundModel* _bg_model;  // adaptive background model, NULL when using the static _bg_hsv_image
 	cv::Mat _foreground_image;
+	cv::Mat _foreground_integral;  // integral image of _foreground_image (CV_32S), when requested
+	bool _foreground_packed;       // the current foreground is the workspace's packed_foreground
 
-	cv::VideoCapture _video;
+	cv::VideoCapture _video;       // until the prefetcher starts, then it has the only reference
+	SeekIndex* _seek_index;        // frame-accurate seek points of _video
+	FramePrefetcher* _prefetcher;  // decodes _video ahead, once initialized
+	FrameStore* _frame_store;      // the decoded frames of _video, if transcoded (replaces decoding)
+	SharedFrameRing* _frame_ring;  // frames from a capture process, if _frame_ring_name is set (replaces _video)
+	std::string _frame_ring_name;
+	bool _live;                    // read the newest frame of _frame_ring, dropping the older ones
 
 	cv::Size _plane_size;
 	long _frames;
+	double _fps;  // frame rate of the video, 0 if unknown
+	double _timestamp;  // seconds of the current frame since the start, 0 if unknown
 
 	cv::Mat _camera_matrix, _distortion_coeffs;
 	cv::Mat _rotation_values, _translation_values;
@@ -47,7 +110,18 @@ class Camera
 	std::vector<cv::Point3f> _camera_plane; // the camera plane of view
 	std::vector<cv::Point3f> _camera_floor; // three points that are the projection of the camera itself to the ground floor view
 
+	std::vector<cv::Range> _volume_spans;  // per row the columns the voxel volume projects to
+	std::vector<cv::Range> _roi;           // _volume_spans grown by _roi_margin pixels
+	cv::Rect _roi_rect;                    // bounding box of _roi
+	int _roi_margin;
+
 	cv::Mat _frame;
+	long _next_frame;        // frame number the video returns next
+	cv::Mat _hsv_frame;      // _frame in HSV-color space, converted at most once per frame
+	bool _hsv_frame_valid;
+	std::vector<cv::Range> _hsv_spans;  // per row the columns _hsv_frame holds, empty if all of them
+
+	Workspace _workspace;
 
 	static void onMouse(int, int, int, int, void*);
 	void initCamLoc();
@@ -65,11 +139,14 @@ public:
 	cv::Mat& advanceVideoFrame();
 	cv::Mat& getVideoFrame(int);
 	void setVideoFrame(int);
+	void setFrame(const cv::Mat &);
 
 	static bool detExtrinsics(const std::string &, const std::string &, const std::string &, const std::string &);
 
 	static cv::Point projectOnView(const cv::Point3f &, const cv::Mat &, const cv::Mat &, const cv::Mat &, const cv::Mat &);
 	cv::Point projectOnView(const cv::Point3f &);
+	void projectOnView(const std::vector<cv::Point3f> &, std::vector<cv::Point> &) const;
+	void projectOnView(const std::vector<cv::Point3f> &, std::vector<cv::Point> &, std::vector<cv::Point2f> &) const;
 
 	const std::string& getCamPropertiesFile() const
 	{
@@ -86,19 +163,34 @@ public:
 		return _id;
 	}
 
-	const cv::VideoCapture& getVideo() const
+	const cv::VideoCapture& getVideo() const;
+	void setVideo(const cv::VideoCapture&);
+
+	long getFramesAmount() const
+	{
+		return _frames;
+	}
+
+	double getFps() const
 	{
-		return _video;
+		return _fps;
 	}
 
-	void setVideo(const cv::VideoCapture& video)
+	double getTimestamp() const
 	{
-		_video = video;
+		return _timestamp;
 	}
 
-	long getFramesAmount() const
+	void setFrameRing(const std::string &name)
 	{
-		return _frames;
+		_frame_ring_name = name;
+	}
+
+	bool isSeekable() const;
+
+	void setLive(bool live)
+	{
+		_live = live;
 	}
 
 	const std::vector<cv::Mat>& getBgHsvChannels() const
@@ -106,6 +198,33 @@ public:
 		return _bg_hsv_channels;
 	}
 
+	const cv::Mat& getBgHsvImage() const
+	{
+		return _bg_hsv_image;
+	}
+
+	const cv::Mat& getBgHsvDeviation() const
+	{
+		return _bg_hsv_deviation;
+	}
+
+	const cv::Mat& getBgYCrCbImage() const
+	{
+		return _bg_ycrcb_image;
+	}
+
+	BackgroundModel* getBackgroundModel() const
+	{
+		return _bg_model;
+	}
+
+	// Takes ownership of the given model
+	void setBackgroundModel(BackgroundModel* bgModel)
+	{
+		delete _bg_model;
+		_bg_model = bgModel;
+	}
+
 	bool isInitialized() const
 	{
 		return _initialized;
@@ -126,11 +245,66 @@ public:
 		_foreground_image = foregroundImage;
 	}
 
+	bool isForegroundPacked() const
+	{
+		return _foreground_packed;
+	}
+
+	// Only valid if isForegroundPacked()
+	const PackedMask& getPackedForeground() const
+	{
+		return _workspace.packed_foreground;
+	}
+
+	void setForegroundPacked(bool foregroundPacked)
+	{
+		_foreground_packed = foregroundPacked;
+	}
+
+	const cv::Mat& getForegroundIntegral() const
+	{
+		return _foreground_integral;
+	}
+
+	void setForegroundIntegral(const cv::Mat& foregroundIntegral)
+	{
+		_foreground_integral = foregroundIntegral;
+	}
+
 	const cv::Mat& getFrame() const
 	{
 		return _frame;
 	}
 
+	long getNextFrame() const
+	{
+		return _next_frame;
+	}
+
+	const cv::Mat& getHsvFrame(const std::vector<cv::Range>* = NULL);
+
+	Workspace& getWorkspace()
+	{
+		return _workspace;
+	}
+
+	void setHsvFrame(const cv::Mat &, const std::vector<cv::Range>* = NULL);
+
+	void setVolumeRoi(const std::vector<cv::Point3f> &);
+	const std::vector<cv::Range>& getRoi(int);
+
+	// Per row the columns the voxel volume projects to, empty if no volume was set
+	const std::vector<cv::Range>& getVolumeSpans() const
+	{
+		return _volume_spans;
+	}
+
+	// Bounding box of the last getRoi()
+	const cv::Rect& getRoiRect() const
+	{
+		return _roi_rect;
+	}
+
 	const std::vector<cv::Point3f>& getCameraFloor() const
 	{
 		return _camera_floor;
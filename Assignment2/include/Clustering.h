@@ -30,23 +30,36 @@ class Clustering
 	//If true, the initial labeling is shown, instead of the final one.
 	//Unlabeled voxels will be shown as gray
 	bool _show_initial;
+	//If false, the initial clustering and the color models aren't shown (without windows)
+	bool _show;
 
 	//vector<Mat> occlusionMap;
 	//vector<vector<bool>> occluded;
 	vector<Point2f> _prev_centers;
 
+	//Per-frame buffers, kept between frames so processFrame doesn't allocate
+	vector<Mat> _frames;
+	Mat _voxel_data;
+	vector<int> _labels;
+	vector<Scalar> _voxel_colors;
+	vector<float> _divergence;
+	vector<Point3i> _average;
+	vector<Point3i> _new_average;
+	vector<Point2f> _initial_centers;
+	vector<Point2f> _cam_to_center;
+
 
 public:
-	Clustering(Scene3DRenderer& scene3d, int, bool);
+	Clustering(Scene3DRenderer& scene3d, int, bool, bool = true);
 	virtual ~Clustering(void);
 	void initializeColorModel();
-	vector<Point2f> processFrame();
+	const vector<Point2f>& processFrame();
 	void makeTextFile();
 	void generate();
 	bool isLocalMinimum(Mat& centers);
-	void processOcclusions(vector<Reconstructor::Voxel*>);
+	void processOcclusions(const vector<Reconstructor::Voxel*>&);
 
-	vector<Scalar> Clustering::getVoxelColors(Reconstructor::Voxel*, int, vector<Mat>);	
+	void Clustering::getVoxelColors(Reconstructor::Voxel*, int, const vector<Mat>&, vector<Scalar>&);	
 	vector<Scalar> Clustering::getVoxelColorsBunchedHSV(vector<Reconstructor::Voxel*>);
 };
 
@@ -0,0 +1,76 @@
+/*
+ * ColorSpace.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef COLORSPACE_H_
+#define COLORSPACE_H_
+
+#include <algorithm>
+
+#include "opencv2/opencv.hpp"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Fast integer color conversions, shared by the whole pipeline
+ */
+class ColorSpace
+{
+	static const int HSV_SHIFT = 12;
+
+	// Fixed point BGR to YCrCb coefficients, identical to the ones cvtColor(CV_BGR2YCrCb) uses for 8 bit images
+	static const int YUV_SHIFT = 14;
+	static const int R2Y = 4899, G2Y = 9617, B2Y = 1868;  // 0.299, 0.587, 0.114
+	static const int Y2CR = 11682, Y2CB = 9241;           // 0.713, 0.564
+
+	// Fixed point reciprocal tables, identical to the ones cvtColor(CV_BGR2HSV) uses for 8 bit images
+	static int _SDivTable[256];
+	static int _HDivTable[256];
+
+	static bool initTables();
+	static const bool _TablesInitialized;
+
+public:
+	static void bgrToHsv(const cv::Mat &, cv::Mat &);
+	static void bgrToHsv(const cv::Mat &, cv::Mat &, int, const cv::Range &);
+	static void bgrToYCrCb(const cv::Mat &, cv::Mat &);
+
+	/**
+	 * Convert one BGR pixel to OpenCV-compatible HSV (H: 0-180, S and V: 0-255), branch free
+	 */
+	static inline void bgrToHsv(int b, int g, int r, int &h, int &s, int &v)
+	{
+		const int round = 1 << (HSV_SHIFT - 1);
+
+		v = std::max(b, std::max(g, r));
+		const int diff = v - std::min(b, std::min(g, r));
+		const int vr = v == r ? -1 : 0;
+		const int vg = v == g ? -1 : 0;
+
+		s = (diff * _SDivTable[v] + round) >> HSV_SHIFT;
+		h = (vr & (g - b)) + (~vr & ((vg & (b - r + 2 * diff)) + ((~vg) & (r - g + 4 * diff))));
+		h = (h * _HDivTable[diff] + round) >> HSV_SHIFT;
+		h += h < 0 ? 180 : 0;
+	}
+
+	/**
+	 * Convert one BGR pixel to OpenCV-compatible YCrCb (all 0-255): a few multiply-adds,
+	 * no divisions or table lookups, so loops over it vectorize
+	 */
+	static inline void bgrToYCrCb(int b, int g, int r, int &y, int &cr, int &cb)
+	{
+		const int round = 1 << (YUV_SHIFT - 1);
+		const int delta = 128 << YUV_SHIFT;
+
+		y = (b * B2Y + g * G2Y + r * R2Y + round) >> YUV_SHIFT;
+		cr = std::min(255, std::max(0, ((r - y) * Y2CR + delta + round) >> YUV_SHIFT));
+		cb = std::min(255, std::max(0, ((b - y) * Y2CB + delta + round) >> YUV_SHIFT));
+	}
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* COLORSPACE_H_ */
@@ -0,0 +1,42 @@
+/*
+ * Foreground.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef FOREGROUND_H_
+#define FOREGROUND_H_
+
+#include "opencv2/opencv.hpp"
+
+#include "ColorSpace.h"
+#include "PackedMask.h"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Fused per-pixel kernels for separating the foreground from the background
+ */
+class Foreground
+{
+public:
+	static void subtractHSV(const cv::Mat &, const cv::Mat &, const cv::Mat &, int, int, int, cv::Mat &, cv::Mat &,
+			const std::vector<cv::Range>* = NULL);
+	static void subtractHSV(const cv::Mat &, const cv::Mat &, const cv::Mat &, int, int, int, PackedMask &,
+			cv::Mat &, const std::vector<cv::Range>* = NULL);
+	static void differenceHSV(const cv::Mat &, const cv::Mat &, const cv::Mat &, cv::Mat &, cv::Mat &);
+	static void thresholdHSV(const cv::Mat &, int, int, int, cv::Mat &, const std::vector<cv::Range>* = NULL);
+	static void thresholdHSV(const cv::Mat &, int, int, int, PackedMask &, const std::vector<cv::Range>* = NULL);
+	static void subtractYCrCb(const cv::Mat &, const cv::Mat &, int, int, cv::Mat &,
+			const std::vector<cv::Range>* = NULL);
+	static void subtractYCrCb(const cv::Mat &, const cv::Mat &, int, int, PackedMask &,
+			const std::vector<cv::Range>* = NULL);
+	static void subtractHSVSparse(const cv::Mat &, const cv::Mat &, const cv::Mat &, int, int, int,
+			const std::vector<int> &,
+			std::vector<unsigned int> &, unsigned int &, cv::Mat &);
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* FOREGROUND_H_ */
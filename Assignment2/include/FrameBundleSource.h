@@ -0,0 +1,113 @@
+/*
+ * FrameBundleSource.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef FRAMEBUNDLESOURCE_H_
+#define FRAMEBUNDLESOURCE_H_
+
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+#include "Camera.h"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * One aligned set of frames, a frame per camera
+ */
+struct FrameBundle
+{
+	int index;                    // frame number of the bundle
+	double timestamp;             // seconds since the start (of the first camera's frame), 0 if unknown
+	std::vector<cv::Mat> frames;  // per camera frame (shares the camera's current frame)
+	std::vector<int> sources;     // per camera frame number the frame was decoded from
+	bool complete;                // every camera had frame 'index'
+
+	FrameBundle() :
+			index(-1), timestamp(0), complete(false)
+	{
+	}
+};
+
+/**
+ * Reads the same frame number from all cameras at once (one decode task per camera) and
+ * delivers them as a bundle, so a camera with a missing frame can't shift the others
+ *
+ * What happens when a camera misses a frame (decoding failed or its video is shorter)
+ * depends on the policy:
+ *  - REPEAT: the camera repeats its last frame (sources tell which), the bundle is incomplete
+ *  - SKIP: move on to the next frame number all cameras have (at most MAX_SKIP frames ahead)
+ *  - DROP: no bundle, the cameras keep their last frames
+ */
+class FrameBundleSource
+{
+public:
+	enum MissingPolicy
+	{
+		REPEAT, SKIP, DROP
+	};
+
+private:
+	static const int MAX_SKIP;
+
+	const std::vector<Camera*> &_cameras;
+	MissingPolicy _policy;
+	int _threads;
+
+	std::vector<cv::Mat> _last;     // per camera last good frame
+	std::vector<int> _last_index;   // per camera frame number of _last, -1 if none
+	std::vector<uchar> _missing;    // per camera, whether the last read missed the frame
+
+	int _repeated, _skipped, _dropped;
+
+	bool decode(int);
+	void restore(std::vector<int> &);
+
+public:
+	FrameBundleSource(const std::vector<Camera*> &);
+
+	bool read(int, FrameBundle &);
+	void reset();
+
+	static const char* getPolicyName(MissingPolicy);
+
+	long getFramesAmount() const;
+
+	MissingPolicy getPolicy() const
+	{
+		return _policy;
+	}
+
+	void setPolicy(MissingPolicy policy)
+	{
+		_policy = policy;
+	}
+
+	void setThreads(int threads)
+	{
+		_threads = threads;
+	}
+
+	int getRepeated() const
+	{
+		return _repeated;
+	}
+
+	int getSkipped() const
+	{
+		return _skipped;
+	}
+
+	int getDropped() const
+	{
+		return _dropped;
+	}
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* FRAMEBUNDLESOURCE_H_ */
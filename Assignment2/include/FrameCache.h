@@ -0,0 +1,117 @@
+/*
+ * FrameCache.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef FRAMECACHE_H_
+#define FRAMECACHE_H_
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+#include "Reconstructor.h"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Bounded cache of the processed frames, so scrubbing back and forth doesn't seek, decode,
+ * segment, carve and cluster the same frames over and over again
+ *
+ * An entry holds a frame's decoded images and, when they could be cached, its derived
+ * products (foreground masks, visible voxels and their cluster labels) together with a
+ * hash of the parameters they were made with. The decoded images stay usable when the
+ * parameters change, the derived products only when the hash matches.
+ *
+ * The total size is bounded by a configurable amount of bytes. Eviction is least recently
+ * used first, but spares the current frame's neighbors (what 'b' and 'n' reach next) as
+ * long as there's another entry to evict. Evicted buffers are recycled by the next insert.
+ */
+class FrameCache
+{
+public:
+	struct Entry
+	{
+		int frame;
+		bool derived;                  // the derived products below are valid for 'parameters'
+		size_t parameters;
+		std::vector<cv::Mat> frames;   // per camera decoded BGR frame
+		std::vector<cv::Mat> foregrounds;  // per camera 8-bit foreground mask
+		std::vector<Reconstructor::Voxel*> visible_voxels;
+		std::vector<cv::Scalar> colors;    // per visible voxel
+		std::vector<int> clusters;
+		size_t bytes;
+
+		Entry() :
+				frame(-1), derived(false), parameters(0), bytes(0)
+		{
+		}
+	};
+
+private:
+	std::list<Entry> _entries;  // most recently used first
+	std::map<int, std::list<Entry>::iterator> _index;
+	std::list<Entry> _spare;    // an evicted entry, its buffers are reused by insert()
+
+	size_t _max_bytes;
+	size_t _bytes;
+	size_t _hits, _misses;
+
+	void evict(int);
+	static size_t measure(const Entry &);
+
+public:
+	FrameCache(size_t);
+
+	Entry* find(int);
+	Entry& insert(int);
+	void commit(Entry &);
+	void clear();
+
+	static size_t hash(size_t, int);
+
+	size_t getMaxBytes() const
+	{
+		return _max_bytes;
+	}
+
+	// 0 disables the cache
+	void setMaxBytes(size_t maxBytes)
+	{
+		_max_bytes = maxBytes;
+		if (_max_bytes == 0) clear();
+	}
+
+	size_t getBytes() const
+	{
+		return _bytes;
+	}
+
+	size_t getSize() const
+	{
+		return _entries.size();
+	}
+
+	size_t getHits() const
+	{
+		return _hits;
+	}
+
+	size_t getMisses() const
+	{
+		return _misses;
+	}
+
+	void countHit(bool hit)
+	{
+		++(hit ? _hits : _misses);
+	}
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* FRAMECACHE_H_ */
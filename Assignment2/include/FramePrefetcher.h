@@ -0,0 +1,88 @@
+/*
+ * FramePrefetcher.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef FRAMEPREFETCHER_H_
+#define FRAMEPREFETCHER_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+namespace nl_uu_science_gmt
+{
+
+class SeekIndex;
+
+/**
+ * Decodes a video ahead on its own thread, into a bounded ring of frames
+ *
+ * Single producer (the decode thread) and single consumer (read()), lock-free: the
+ * producer only advances the tail, the consumer only the head. Every frame is tagged
+ * with its frame number and the seek it was decoded after:
+ *  - backpressure: the producer waits while the ring is full
+ *  - seeking: reading another frame than the next one publishes a new seek (frame and
+ *    epoch in one atomic word), the producer repositions the video and the consumer
+ *    drops the frames of earlier seeks. A frame a little ahead is decoded on to instead
+ *    (the consumer drops the frames in between), as long as that's cheaper than a seek.
+ *  - at the end of the video the producer queues an empty frame and waits for a seek
+ * Without start() (or with 0 slots) read() decodes synchronously. Seeks go through the
+ * video's SeekIndex if there is one, otherwise through CV_CAP_PROP_POS_FRAMES.
+ */
+class FramePrefetcher
+{
+	struct Slot
+	{
+		cv::Mat frame;
+		long number;
+		uint32_t epoch;
+	};
+
+	cv::VideoCapture _video;
+	const SeekIndex* _index;        // frame-accurate seeking, if not NULL
+	std::vector<Slot> _slots;
+	std::thread _thread;
+
+	std::atomic<size_t> _head;      // next slot to read, written by the consumer
+	std::atomic<size_t> _tail;      // next slot to write, written by the producer
+	std::atomic<uint64_t> _seek;    // epoch << 32 | frame number of the last seek
+	std::atomic<bool> _stop;
+
+	// Consumer state
+	uint32_t _epoch;
+	long _expected;                 // frame number the ring holds next (within _epoch)
+
+	static uint64_t packSeek(uint32_t epoch, long number)
+	{
+		return ((uint64_t) epoch << 32) | (uint32_t) number;
+	}
+
+	void decode();
+	void position(long);
+	bool isAhead(long) const;
+
+	FramePrefetcher(const FramePrefetcher &);
+	FramePrefetcher& operator=(const FramePrefetcher &);
+
+public:
+	FramePrefetcher();
+	virtual ~FramePrefetcher();
+
+	void start(const cv::VideoCapture &, size_t, const SeekIndex* = NULL);
+	void stop();
+	bool read(long, cv::Mat &);
+
+	bool isRunning() const
+	{
+		return _thread.joinable();
+	}
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* FRAMEPREFETCHER_H_ */
@@ -0,0 +1,101 @@
+/*
+ * FrameStore.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef FRAMESTORE_H_
+#define FRAMESTORE_H_
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+#include <stdint.h>
+#include <string>
+
+#include "opencv2/opencv.hpp"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * A video's decoded frames in a flat, uncompressed file that is memory-mapped, so repeated
+ * runs don't decode at all and reading a frame is a Mat header over the mapping (O(1), no copy)
+ *
+ * The file is a header (identifying the video by its size in bytes and its modification time,
+ * and on opening checked against the video's first frame) followed by the frames,
+ * each at data offset + number * frame stride: the BGR image and, in the BGR_HSV format,
+ * the same frame in HSV-color space (as ColorSpace::bgrToHsv converts it). Frames are
+ * 64 byte aligned, the data starts at a page boundary. transcode() writes it once.
+ *
+ * The mapping is read-only: frame() headers must not be written to.
+ */
+class FrameStore
+{
+public:
+	enum Format  // the value is the amount of images per frame
+	{
+		BGR = 1, BGR_HSV = 2
+	};
+
+private:
+	static const uint32_t MAGIC;
+	static const int32_t VERSION;
+	static const size_t HEADER_BYTES;
+
+	const uchar* _data;  // the mapped file, NULL if not open
+	size_t _bytes;
+#ifdef _WIN32
+	HANDLE _file;
+	HANDLE _mapping;
+#else
+	int _file;
+#endif
+
+	int _frames;
+	cv::Size _size;
+	Format _format;
+	size_t _frame_stride;
+
+	static bool readHeader(std::istream &, int64_t &, int64_t &, int &, cv::Size &, Format &, size_t &);
+
+	FrameStore(const FrameStore &);
+	FrameStore& operator=(const FrameStore &);
+
+public:
+	FrameStore();
+	virtual ~FrameStore();
+
+	static bool transcode(const std::string &, const std::string &, Format);
+	static bool isCurrent(const std::string &, const std::string &, Format);
+
+	bool open(const std::string &, const std::string &);
+	void close();
+
+	cv::Mat frame(int) const;
+	cv::Mat hsvFrame(int) const;
+
+	bool isOpen() const
+	{
+		return _data != NULL;
+	}
+
+	int getFramesAmount() const
+	{
+		return _frames;
+	}
+
+	const cv::Size& getSize() const
+	{
+		return _size;
+	}
+
+	Format getFormat() const
+	{
+		return _format;
+	}
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* FRAMESTORE_H_ */
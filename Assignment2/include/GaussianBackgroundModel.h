@@ -0,0 +1,41 @@
+/*
+ * GaussianBackgroundModel.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef GAUSSIANBACKGROUNDMODEL_H_
+#define GAUSSIANBACKGROUNDMODEL_H_
+
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+#include "BackgroundModel.h"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Single Gaussian per pixel and channel, a channel differs from the background
+ * if it's further than both the threshold and 2.5 standard deviations from the mean
+ */
+class GaussianBackgroundModel: public BackgroundModel
+{
+	static const int INITIAL_VARIANCE;
+	static const int MINIMUM_VARIANCE;
+
+	std::vector<int> _mean;      // per pixel and channel, 8.8 fixed point
+	std::vector<int> _variance;  // per pixel and channel, 8 fractional bits
+
+public:
+	GaussianBackgroundModel(const cv::Mat &);
+	virtual ~GaussianBackgroundModel();
+
+	void apply(const cv::Mat &, int, int, int, bool, cv::Mat &);
+	void getBackground(cv::Mat &) const;
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* GAUSSIANBACKGROUNDMODEL_H_ */
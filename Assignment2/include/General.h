@@ -8,6 +8,7 @@
 #ifndef GENERAL_H_
 #define GENERAL_H_
 
+#include <stdint.h>
 #include <fstream>
 #include "opencv2/opencv.hpp"
 
@@ -49,9 +50,19 @@ public:
 	static const std::string VideoFile;
 	static const std::string BackgroundImageFile;
 	static const std::string BackgroundVideoFile;
+	static const std::string BackgroundStatsFile;
+	static const std::string SeekIndexFile;
+	static const std::string VideoInfoFile;
+	static const std::string FrameStoreFile;
 	static const std::string ConfigFile;
 
 	static bool fexists(const std::string &);
+	static int64_t fsize(const std::string &);
+	static int64_t fmtime(const std::string &);
+
+#ifdef DEBUG
+	static size_t getAllocations();
+#endif
 };
 
 } /* namespace nl_uu_science_gmt */
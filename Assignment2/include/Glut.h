@@ -38,6 +38,8 @@ class Glut
 {
 	Scene3DRenderer &_scene3d;
 	Clustering &_clustering;
+	bool _redisplay;  // live: a frame was processed and may be drawn
+	int _key_presses; // changes of the settings, the first frame after one may allocate its buffers
 
 	static Glut* _glut;
 
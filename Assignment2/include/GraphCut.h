@@ -0,0 +1,93 @@
+/*
+ * GraphCut.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef GRAPHCUT_H_
+#define GRAPHCUT_H_
+
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+#include "Morphology.h"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Foreground refinement by a max-flow/min-cut segmentation, limited to a narrow band
+ *
+ * Only the pixels within `band` pixels of the thresholded silhouette's boundary become
+ * graph nodes, the rest keeps its thresholded label and constrains the band through
+ * the links to it. The data terms come from the HSV differences with the background
+ * (neutral at the thresholds), the 4-connected smoothness terms are weaker across
+ * value (brightness) edges. The max-flow is Boykov-Kolmogorov's. The graph and all
+ * buffers are kept between calls, so keep one instance per camera.
+ */
+class GraphCut
+{
+	typedef int Capacity;
+
+	// Node parent arc values that are not an arc
+	static const int FREE = -1;
+	static const int TERMINAL = -2;
+	static const int ORPHAN = -3;
+
+	struct Node
+	{
+		int first;          // first outgoing arc
+		int parent;         // arc to the parent in the search tree, or FREE, TERMINAL, ORPHAN
+		int time;           // time stamp of the distance to the terminal
+		int distance;       // distance to the terminal
+		bool sink;          // in the sink tree (or source tree)
+		bool active;
+		Capacity terminal;  // residual capacity: > 0 from the source, < 0 to the sink
+	};
+
+	// Arcs are added in pairs, the reverse of arc a is a ^ 1
+	struct Arc
+	{
+		int head;
+		int next;           // next outgoing arc of the same tail
+		Capacity residual;
+	};
+
+	std::vector<Node> _nodes;
+	std::vector<Arc> _arcs;
+	std::vector<int> _active;   // FIFO of active nodes
+	size_t _active_first;
+	std::vector<int> _orphans;
+	int _time;
+	Capacity _flow;
+
+	cv::Mat _outer, _inner;     // silhouette dilated and eroded by the band width
+	cv::Mat _node_index;        // band pixel to node, -1 outside the band
+	Morphology _morphology;
+	std::vector<Capacity> _smoothness_lut;
+	int _smoothness;
+
+	void clear();
+	int addNode();
+	void addTerminalWeights(int, Capacity, Capacity);
+	void addEdge(int, int, Capacity, Capacity);
+	Capacity maxflow();
+	bool isSource(int) const;
+
+	void setActive(int);
+	int nextActive();
+	void setOrphan(int);
+	void augment(int);
+	void adoptSourceOrphan(int);
+	void adoptSinkOrphan(int);
+
+public:
+	GraphCut();
+
+	void segment(const cv::Mat &, const cv::Mat &, const cv::Mat &, int, int, int, int, int, cv::Mat &);
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* GRAPHCUT_H_ */
@@ -0,0 +1,114 @@
+/*
+ * LiveScheduler.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef LIVESCHEDULER_H_
+#define LIVESCHEDULER_H_
+
+#include <chrono>
+#include <ostream>
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Paces the live mode by the wall clock: a frame is due (1 / fps) after the previous one,
+ * so the processing always takes the newest frame and drops the ones it didn't get to,
+ * instead of lagging further and further behind
+ *
+ * Within a frame period every stage has a deadline (a fraction of the period). Segmentation
+ * and carving always run, the optional stages (clustering, rendering) are skipped when the
+ * frame is already past their deadline. Keeps the drop, skip, deadline miss and latency
+ * statistics (latency: from when a frame was due until it was done).
+ */
+class LiveScheduler
+{
+public:
+	enum Stage
+	{
+		SEGMENTATION, CARVING, CLUSTERING, RENDERING, STAGES
+	};
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	static const double STAGE_DEADLINES[STAGES];  // fraction of the frame period
+	static const double REPORT_INTERVAL;          // seconds between reports
+
+	bool _running;
+	double _period;             // seconds per frame
+	Clock::time_point _start;   // when frame _start_frame was due
+	int _start_frame;
+
+	Clock::time_point _frame_due;  // when the current frame was due
+	Clock::time_point _report;     // when the statistics were reported last
+
+	long _frames, _dropped;
+	long _skipped[STAGES], _missed[STAGES];
+	double _latency_sum, _latency_max;
+
+	double getElapsed() const;
+
+public:
+	LiveScheduler();
+
+	void start(int, double);
+	void stop();
+	void reset();
+
+	int getDueFrame() const;
+	void drop(long);
+
+	void beginFrame(int);
+	bool admit(Stage);
+	void endStage(Stage);
+	void endFrame();
+
+	bool isReportDue() const;
+	void report(std::ostream &);
+
+	static const char* getStageName(Stage);
+
+	bool isRunning() const
+	{
+		return _running;
+	}
+
+	double getPeriod() const
+	{
+		return _period;
+	}
+
+	long getFrames() const
+	{
+		return _frames;
+	}
+
+	long getDropped() const
+	{
+		return _dropped;
+	}
+
+	// Fraction of the frames that were due which got dropped
+	double getDropRatio() const
+	{
+		return _frames + _dropped > 0 ? (double) _dropped / (_frames + _dropped) : 0;
+	}
+
+	// Average latency in seconds
+	double getLatency() const
+	{
+		return _frames > 0 ? _latency_sum / _frames : 0;
+	}
+
+	double getMaxLatency() const
+	{
+		return _latency_max;
+	}
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* LIVESCHEDULER_H_ */
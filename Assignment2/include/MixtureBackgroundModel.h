@@ -0,0 +1,50 @@
+/*
+ * MixtureBackgroundModel.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef MIXTUREBACKGROUNDMODEL_H_
+#define MIXTUREBACKGROUNDMODEL_H_
+
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+#include "BackgroundModel.h"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Multi-modal (MoG-style) background model: a few weighted Gaussians per pixel,
+ * the heaviest modes that together hold most of the weight are background
+ */
+class MixtureBackgroundModel: public BackgroundModel
+{
+	struct Mode
+	{
+		int weight;    // 16 fractional bits, the weights of a pixel add up to 1
+		int variance;  // shared by the channels, 8 fractional bits
+		int mean[3];   // 8.8 fixed point
+	};
+
+	static const int MODES = 3;
+	static const int ONE;
+	static const int BACKGROUND_WEIGHT;
+	static const int INITIAL_VARIANCE;
+	static const int MINIMUM_VARIANCE;
+
+	std::vector<Mode> _modes;  // per pixel, sorted on descending weight
+
+public:
+	MixtureBackgroundModel(const cv::Mat &);
+	virtual ~MixtureBackgroundModel();
+
+	void apply(const cv::Mat &, int, int, int, bool, cv::Mat &);
+	void getBackground(cv::Mat &) const;
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* MIXTUREBACKGROUNDMODEL_H_ */
@@ -0,0 +1,125 @@
+/*
+ * PackedMask.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef PACKEDMASK_H_
+#define PACKEDMASK_H_
+
+#include <stdint.h>
+#include <vector>
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#include "opencv2/opencv.hpp"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Binary mask stored at one bit per pixel
+ *
+ * Pixel x of row y is bit (x % 64) of word (x / 64) of that row, rows start on a word.
+ * The bits beyond the last column of a row are always 0. summarize() keeps per row the
+ * popcount up to each word, so count() sums a rectangle in O(height) popcounts.
+ */
+class PackedMask
+{
+	int _rows, _cols;
+	int _words_per_row;
+	std::vector<uint64_t> _words;
+	std::vector<int> _row_counts;  // [y * (words per row + 1) + w] = set bits of row y before word w
+
+public:
+	static const int WORD_BITS = 64;
+
+	PackedMask();
+
+	void create(int, int);
+	void pack(const cv::Mat &);
+	void unpack(cv::Mat &) const;
+	void summarize();
+	int count(const cv::Rect &) const;
+
+	static int popcount(uint64_t word)
+	{
+#if defined(__GNUC__)
+		return __builtin_popcountll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		return (int) __popcnt64(word);
+#else
+		word = word - ((word >> 1) & 0x5555555555555555ULL);
+		word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+		word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		return (int) ((word * 0x0101010101010101ULL) >> 56);
+#endif
+	}
+
+	bool empty() const
+	{
+		return _words.empty();
+	}
+
+	int rows() const
+	{
+		return _rows;
+	}
+
+	int cols() const
+	{
+		return _cols;
+	}
+
+	int getWordsPerRow() const
+	{
+		return _words_per_row;
+	}
+
+	uint64_t* row(int y)
+	{
+		return &_words[y * _words_per_row];
+	}
+
+	const uint64_t* row(int y) const
+	{
+		return &_words[y * _words_per_row];
+	}
+
+	const uint64_t* getWords() const
+	{
+		return &_words[0];
+	}
+
+	/**
+	 * Offset of pixel (x, y) for testOffset(): rows are getWordsPerRow() * WORD_BITS bits apart
+	 */
+	int getBitOffset(int x, int y) const
+	{
+		return y * _words_per_row * WORD_BITS + x;
+	}
+
+	bool testOffset(int bit_offset) const
+	{
+		return (_words[bit_offset / WORD_BITS] >> (bit_offset % WORD_BITS)) & 1;
+	}
+
+	/**
+	 * The valid bits of the last word of a row
+	 */
+	uint64_t getLastWordMask() const
+	{
+		const int bits = _cols % WORD_BITS;
+		return bits == 0 ? ~(uint64_t) 0 : ((uint64_t) 1 << bits) - 1;
+	}
+
+	bool test(int x, int y) const
+	{
+		return (row(y)[x / WORD_BITS] >> (x % WORD_BITS)) & 1;
+	}
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* PACKEDMASK_H_ */
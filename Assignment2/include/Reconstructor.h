@@ -23,11 +23,15 @@ public:
 	struct Voxel
 	{
 		int x, y, z;
+		//Edge length of the voxel (smaller than the step for refined sub-voxels)
+		int size;
 		//Displayed color, result of the tracking
 		cv::Scalar color;
 		int cluster;
 		std::vector<cv::Point> camera_projection;
 		std::vector<int> valid_camera_projection;
+		//Bounding rectangle of the projected voxel cube per camera (clipped to the image)
+		std::vector<cv::Rect> camera_footprint;
 		std::vector<bool> occluded_from_camera;
 	};
 
@@ -37,22 +41,77 @@ private:
 	int _step;
 	int _size;
 
+	// Sub-voxel refinement factor at silhouette boundaries (1 = off, 2, 4 or 8)
+	int _refine_factor;
+
+	// Test the foreground fraction of the voxel's footprint instead of only its center pixel
+	bool _footprint_mode;
+	float _footprint_fraction;
+
 	std::vector<cv::Point3f*> _corners;
 
-	size_t _voxels_amount;
+	size_t _voxels_amount;                // amount of voxel index slots
+	int _x_voxels, _y_voxels, _z_voxels;  // dimensions of the voxel grid
+
+	// Store the voxel LUTs, occupancy and attributes in Morton (Z-order) instead of z-y-x row-major order
+	const bool _morton_order;
+	// Per axis grid position to Morton code bits, the code is the OR of the three
+	std::vector<int> _morton_x, _morton_y, _morton_z;
 	cv::Size _plane_size;
 
 	std::vector<Voxel*> _voxels;
 	std::vector<Voxel*> _visible_voxels;
+	std::vector<Voxel*> _coarse_voxels;   // interior voxels of refine(), swapped with _visible_voxels
+
+	// Flat LUT of the voxel projections: [voxel * cameras + camera] = pixel offset in the mask, or -1 if invalid
+	std::vector<int> _projection_offsets;
+
+	// Same LUT as bit offsets in the packed masks (see PackedMask::getBitOffset), built on first use
+	std::vector<int> _projection_bits;
+
+	// Per camera the distinct pixel offsets of the valid voxel projections, in memory order
+	std::vector<std::vector<int> > _referenced_pixels;
+
+	// Carving kernels for the rig's amount of cameras (8-bit and packed masks), chosen once at construction
+	void (Reconstructor::*_carve)();
+	void (Reconstructor::*_carve_packed)();
+	std::vector<const uchar*> _masks;     // per camera foreground mask pointers of carveGeneric()
+	std::vector<const uint64_t*> _packed_masks;
+	bool _packed;                         // this update carves from the cameras' packed masks
+
+	std::vector<uchar> _occupancy;        // coarse occupancy of the last update, indexed like _voxels
+	std::vector<Voxel*> _sub_voxels;      // pool of refined sub-voxels, reused between frames
+	size_t _sub_voxels_used;
 
 	void initialize();
+	template<int CAMERAS, bool PACKED> void carve();
+	void carveGeneric();
+	void buildProjectionBits();
+	void findReferencedPixels();
+	bool inFootprint(const Voxel*, size_t) const;
+	void refine();
+	bool isBoundary(int, int, int) const;
+	Voxel* acquireSubVoxel();
+
+	static void spreadBits(std::vector<int> &, int, const std::vector<int> &);
 
 public:
-	Reconstructor(const std::vector<Camera*> &);
+	Reconstructor(const std::vector<Camera*> &, bool = false);
 	virtual ~Reconstructor();
 
 	void update();
 
+	static void findReferencedPixels(const std::vector<Camera*> &, int, int, std::vector<std::vector<int> > &);
+
+	/**
+	 * The voxel's index from its grid position (row-major or Morton order)
+	 */
+	int voxelIndex(int xp, int yp, int zp) const
+	{
+		if (_morton_order) return _morton_x[xp] | _morton_y[yp] | _morton_z[zp];
+		return zp * _y_voxels * _x_voxels + yp * _x_voxels + xp;
+	}
+
 	const std::vector<Voxel*>& getVisibleVoxels() const
 	{
 		return _visible_voxels;
@@ -83,6 +142,53 @@ public:
 		return _size;
 	}
 
+	int getStep() const
+	{
+		return _step;
+	}
+
+	bool isMortonOrder() const
+	{
+		return _morton_order;
+	}
+
+	int getRefineFactor() const
+	{
+		return _refine_factor;
+	}
+
+	void setRefineFactor(int refineFactor)
+	{
+		assert(refineFactor == 1 || refineFactor == 2 || refineFactor == 4 || refineFactor == 8);
+		_refine_factor = refineFactor;
+	}
+
+	bool isFootprintMode() const
+	{
+		return _footprint_mode;
+	}
+
+	void setFootprintMode(bool footprintMode)
+	{
+		_footprint_mode = footprintMode;
+	}
+
+	float getFootprintFraction() const
+	{
+		return _footprint_fraction;
+	}
+
+	void setFootprintFraction(float footprintFraction)
+	{
+		_footprint_fraction = footprintFraction;
+	}
+
+	// The pixels of camera 'camera' the (unrefined, center pixel) carving reads
+	const std::vector<int>& getReferencedPixels(size_t camera) const
+	{
+		return _referenced_pixels[camera];
+	}
+
 	const cv::Size& getPlaneSize() const
 	{
 		return _plane_size;
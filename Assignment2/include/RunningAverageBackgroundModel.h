@@ -0,0 +1,36 @@
+/*
+ * RunningAverageBackgroundModel.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef RUNNINGAVERAGEBACKGROUNDMODEL_H_
+#define RUNNINGAVERAGEBACKGROUNDMODEL_H_
+
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+#include "BackgroundModel.h"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Exponential running average of the background pixels
+ */
+class RunningAverageBackgroundModel: public BackgroundModel
+{
+	std::vector<int> _mean;  // per pixel and channel, 8.8 fixed point
+
+public:
+	RunningAverageBackgroundModel(const cv::Mat &);
+	virtual ~RunningAverageBackgroundModel();
+
+	void apply(const cv::Mat &, int, int, int, bool, cv::Mat &);
+	void getBackground(cv::Mat &) const;
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* RUNNINGAVERAGEBACKGROUNDMODEL_H_ */
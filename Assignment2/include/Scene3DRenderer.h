@@ -19,10 +19,16 @@
 #include "General.h"
 #include "Reconstructor.h"
 #include "Camera.h"
+#include "Foreground.h"
+#include "FrameCache.h"
+#include "FrameBundleSource.h"
+#include "LiveScheduler.h"
 
 namespace nl_uu_science_gmt
 {
 
+class Clustering;
+
 class Scene3DRenderer
 {
 	Reconstructor &_reconstructor;
@@ -69,6 +75,25 @@ class Scene3DRenderer
 
 	int _e_factor;
 	int _d_factor;
+
+	int _band_width;  // graph cut band half width around the thresholded silhouette (USE_GRAPHCUTS)
+	int _smoothness;  // graph cut smoothness weight (USE_GRAPHCUTS)
+
+	int _bg_model_type;  // BackgroundModel::Type used by processForeground
+	bool _packed_masks;  // produce 1-bit per pixel foreground masks (Camera::getPackedForeground)
+	bool _volume_roi;    // only segment the part of the views the voxel volume projects to
+	bool _sparse_foreground;  // only segment the pixels the carving reads (see processForeground)
+	bool _ycrcb_segmentation;  // subtract the static background in YCrCb instead of HSV
+
+	int _threads;  // thread budget for the per-camera foreground processing
+	FrameCache _frame_cache;  // processed frames, for scrubbing (see restoreFrame/storeFrame)
+	FrameBundleSource _bundle_source;  // aligned frames of all cameras
+	FrameBundle _bundle;               // the last bundle read
+	bool _live;                        // take the newest frame by the clock, dropping stale ones
+	LiveScheduler _live_scheduler;     // paces the live mode
+#ifdef DEBUG
+	size_t _frame_allocations;         // operator new calls by the last processStages()
+#endif
 	// edge points of the virtual ground floor grid
 	std::vector<std::vector<cv::Point3i*> > _floor_grid;
 
@@ -79,12 +104,19 @@ class Scene3DRenderer
 #endif
 
 public:
-	Scene3DRenderer(Reconstructor &, const std::vector<Camera*> &);
+	Scene3DRenderer(Reconstructor &, const std::vector<Camera*> &, bool = true);
 	virtual ~Scene3DRenderer();
 
-	void processForeground(Camera*);
+	void processForeground(Camera*, bool = false);
 
 	bool processFrame();
+	void processThresholds();
+	size_t getParameterHash() const;
+	bool restoreFrame();
+	void storeFrame();
+	void advanceLive();
+	bool processStages(Clustering &);
+	void benchmarkSparseForeground(int);
 	void setCamera(int);
 	void setTopView();
 
@@ -361,6 +393,16 @@ public:
 		return _e_factor;
 	}
 
+	int getBandWidth() const
+	{
+		return _band_width;
+	}
+
+	int getSmoothness() const
+	{
+		return _smoothness;
+	}
+
 
 	void setPHThreshold(int phThreshold)
 	{
@@ -402,6 +444,118 @@ public:
 		_d_factor = factor;
 	}
 
+	void setBandWidth(int bandWidth)
+	{
+		_band_width = bandWidth;
+	}
+
+	void setSmoothness(int smoothness)
+	{
+		_smoothness = smoothness;
+	}
+
+	bool isPackedMasks() const
+	{
+		return _packed_masks;
+	}
+
+	void setPackedMasks(bool packedMasks)
+	{
+		_packed_masks = packedMasks;
+	}
+
+	bool isVolumeRoi() const
+	{
+		return _volume_roi;
+	}
+
+	void setVolumeRoi(bool volumeRoi)
+	{
+		_volume_roi = volumeRoi;
+	}
+
+	bool isSparseForeground() const
+	{
+		return _sparse_foreground;
+	}
+
+	void setSparseForeground(bool sparseForeground)
+	{
+		_sparse_foreground = sparseForeground;
+	}
+
+	bool isYCrCbSegmentation() const
+	{
+		return _ycrcb_segmentation;
+	}
+
+	void setYCrCbSegmentation(bool ycrcbSegmentation)
+	{
+		_ycrcb_segmentation = ycrcbSegmentation;
+	}
+
+	FrameCache& getFrameCache()
+	{
+		return _frame_cache;
+	}
+
+	int getThreads() const
+	{
+		return _threads;
+	}
+
+	void setThreads(int threads)
+	{
+		_threads = threads;
+		_bundle_source.setThreads(threads);
+	}
+
+	FrameBundleSource& getBundleSource()
+	{
+		return _bundle_source;
+	}
+
+	bool isLive() const
+	{
+		return _live;
+	}
+
+	void setLive(bool live)
+	{
+		_live = live;
+		for (size_t c = 0; c < _cameras.size(); ++c)
+			_cameras[c]->setLive(live);
+		_live_scheduler.stop();
+		_live_scheduler.reset();
+	}
+
+	LiveScheduler& getLiveScheduler()
+	{
+		return _live_scheduler;
+	}
+
+#ifdef DEBUG
+	size_t getFrameAllocations() const
+	{
+		return _frame_allocations;
+	}
+#endif
+
+	const FrameBundle& getBundle() const
+	{
+		return _bundle;
+	}
+
+	int getBgModelType() const
+	{
+		return _bg_model_type;
+	}
+
+	void setBgModelType(int bgModelType)
+	{
+		_bg_model_type = bgModelType;
+	}
+
 	const cv::Size& getBoardSize() const
 	{
 		return _board_size;
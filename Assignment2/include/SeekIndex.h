@@ -0,0 +1,75 @@
+/*
+ * SeekIndex.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SEEKINDEX_H_
+#define SEEKINDEX_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Frame-accurate random access into a video
+ *
+ * Seeking with CV_CAP_PROP_POS_FRAMES is only exact at some positions for some codecs
+ * (the keyframes), elsewhere it can land on a wrong frame. The candidate seek points are
+ * the keyframes of the AVI index (see VideoMetadata::readKeyframes). Without one (not an
+ * AVI, or an OpenDML file) every SEEK_INTERVAL-th frame is a candidate instead, which is
+ * only an approximation: a seek to it may still decode from an earlier keyframe internally.
+ * The index decodes the video once, hashes every frame and keeps the candidates where a
+ * seek demonstrably lands on the right frames. A seek jumps to the nearest such position
+ * at or before the frame (or reopens the video) and decodes forward from there.
+ *
+ * The index is built once and cached in a file. The cache is identified by the video's
+ * size, modification time and first frame, it's rebuilt when any of them changes.
+ */
+class SeekIndex
+{
+	static const uint32_t MAGIC;
+	static const int32_t VERSION;
+	static const int SEEK_INTERVAL;
+
+	std::string _video_path;
+	std::vector<uint64_t> _hashes;  // per frame, of the sequentially decoded video
+	std::vector<int> _points;       // frames a seek lands on exactly, ascending
+
+	bool build();
+	bool load(const std::string &, int64_t, int64_t);
+	bool save(const std::string &, int64_t, int64_t) const;
+
+public:
+	bool obtain(const std::string &, const std::string &);
+	int getSeekPoint(int) const;
+	void seek(cv::VideoCapture &, int) const;
+	bool verify(int) const;
+
+	static uint64_t hashFrame(const cv::Mat &);
+
+	bool isEmpty() const
+	{
+		return _hashes.empty();
+	}
+
+	// The exact amount of frames of the video
+	int getFramesAmount() const
+	{
+		return (int) _hashes.size();
+	}
+
+	const std::vector<int>& getPoints() const
+	{
+		return _points;
+	}
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* SEEKINDEX_H_ */
@@ -0,0 +1,104 @@
+/*
+ * SharedFrameRing.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef SHAREDFRAMERING_H_
+#define SHAREDFRAMERING_H_
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+#include "opencv2/opencv.hpp"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * A ring of BGR frames in POSIX shared memory, written by a capture process and read by
+ * this one without copying: a frame read is a Mat header over its slot
+ *
+ * One producer (create/write/finish) and one consumer (open/read), lock-free like the
+ * FramePrefetcher, but with the counters in the shared header:
+ *  - the producer only advances the tail, after the slot's pixels and sequence number
+ *    (the frame number and timestamp) were written
+ *  - the consumer only advances the head, and holds the slot at the head until its next
+ *    read, so the frame it was given isn't overwritten while it's in use
+ *  - a capture can't wait: when the ring is full the producer drops the new frame (and
+ *    counts it), the consumer can skip to the latest frame to catch up
+ * Not available on Windows (create/open fail).
+ */
+class SharedFrameRing
+{
+	struct Header
+	{
+		uint32_t magic;
+		int32_t version;
+		int32_t width, height;
+		int32_t slots;
+		int32_t padding;
+		uint64_t slot_stride;           // bytes per slot: the slot header and the pixels
+		std::atomic<uint64_t> head;     // frames released by the consumer
+		std::atomic<uint64_t> tail;     // frames published by the producer
+		std::atomic<uint64_t> dropped;  // frames the producer dropped as the ring was full
+		std::atomic<uint32_t> finished; // the producer won't write any more frames
+	};
+
+	struct Slot
+	{
+		int64_t number;    // frame number, as numbered by the producer
+		double timestamp;  // seconds, as the producer measured them
+	};
+
+	static const uint32_t MAGIC;
+	static const int32_t VERSION;
+	static const size_t HEADER_BYTES;
+	static const size_t SLOT_HEADER_BYTES;
+
+	std::string _name;
+	bool _owner;       // created (and unlinks) the shared memory
+	uchar* _data;      // the mapped shared memory, NULL if not open
+	size_t _bytes;
+	Header* _header;
+	bool _holding;     // the consumer holds the slot at the head
+
+	uchar* slot(uint64_t) const;
+
+	SharedFrameRing(const SharedFrameRing &);
+	SharedFrameRing& operator=(const SharedFrameRing &);
+
+public:
+	SharedFrameRing();
+	virtual ~SharedFrameRing();
+
+	static std::string getName(int);
+
+	bool create(const std::string &, const cv::Size &, int);
+	bool open(const std::string &);
+	void close();
+
+	bool write(const cv::Mat &, int64_t, double);
+	void finish();
+	bool read(cv::Mat &, int64_t &, double &, int, bool = false);
+
+	bool isOpen() const
+	{
+		return _data != NULL;
+	}
+
+	cv::Size getSize() const
+	{
+		return _header != NULL ? cv::Size(_header->width, _header->height) : cv::Size();
+	}
+
+	uint64_t getDropped() const
+	{
+		return _header != NULL ? _header->dropped.load(std::memory_order_relaxed) : 0;
+	}
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* SHAREDFRAMERING_H_ */
@@ -0,0 +1,54 @@
+/*
+ * VideoMetadata.h
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#ifndef VIDEOMETADATA_H_
+#define VIDEOMETADATA_H_
+
+#include <stdint.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Frame count, frame rate and resolution of a video, read from its container instead of
+ * decoding or seeking through it
+ *
+ * Only AVI (RIFF) is understood: the main header (avih), the stream headers (strh/strf) of
+ * the first video stream and, for OpenDML files larger than 1GB, the extended header (dmlh),
+ * which holds the frame count of all RIFF parts. Probing reads a few KB at the start of the
+ * file; the result is kept in a small binary file (next to the camera's other files), which
+ * is rewritten when the video changes (another size, modification time or first frame). The
+ * keyframes come from the legacy index (idx1) at the end of the file, see readKeyframes().
+ */
+class VideoMetadata
+{
+	static const uint32_t MAGIC;
+	static const int32_t VERSION;
+
+	bool walk(std::ifstream &, int64_t, bool &, bool &);
+
+public:
+	int frames;     // amount of video frames, 0 if unknown
+	double fps;     // frames per second, 0 if unknown
+	cv::Size size;  // frame resolution
+
+	VideoMetadata();
+
+	bool obtain(const std::string &, const std::string &);
+	bool probe(const std::string &);
+	static bool readKeyframes(const std::string &, std::vector<int> &);
+	bool load(const std::string &, const std::string &, int64_t, int64_t);
+	bool save(const std::string &, int64_t, int64_t, uint64_t) const;
+};
+
+} /* namespace nl_uu_science_gmt */
+
+#endif /* VIDEOMETADATA_H_ */
@@ -25,18 +25,23 @@ namespace nl_uu_science_gmt
 
 class VoxelReconstruction
 {
+	static const double MAX_DROP_RATIO;       // live replay: at most this part of the frames dropped
+	static const double MAX_LATENCY_PERIODS;  // live replay: average latency in frame periods
+
 	const std::string _data_path;
 	const int _cam_views_amount;
 
 	std::vector<Camera*> _cam_views;
 
+	int replayLive(Scene3DRenderer &, Clustering &, double);
+
 public:
 	VoxelReconstruction(const std::string &, const int);
 	virtual ~VoxelReconstruction();
 
 	static void showKeys();
 
-	void run(int, char**);
+	int run(int, char**);
 };
 
 } /* namespace nl_uu_science_gmt */
@@ -0,0 +1,65 @@
+/*
+ * BackgroundModel.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "BackgroundModel.h"
+#include "RunningAverageBackgroundModel.h"
+#include "GaussianBackgroundModel.h"
+#include "MixtureBackgroundModel.h"
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+BackgroundModel::BackgroundModel(Type type, const Size &size) :
+		_type(type), _size(size)
+{
+	_learning_shift = 7;  // alpha = 1/128, adapts to lighting drift within a few seconds
+}
+
+BackgroundModel::~BackgroundModel()
+{
+}
+
+/**
+ * Create a background model of the given type, initialized with the HSV background image
+ * (the static model has no state, it returns NULL)
+ */
+BackgroundModel* BackgroundModel::create(Type type, const Mat &bg_hsv_image)
+{
+	switch (type)
+	{
+	case RUNNING_AVERAGE:
+		return new RunningAverageBackgroundModel(bg_hsv_image);
+	case GAUSSIAN:
+		return new GaussianBackgroundModel(bg_hsv_image);
+	case MIXTURE:
+		return new MixtureBackgroundModel(bg_hsv_image);
+	default:
+		return NULL;
+	}
+}
+
+/**
+ * Human readable model name
+ */
+string BackgroundModel::getTypeName(Type type)
+{
+	switch (type)
+	{
+	case RUNNING_AVERAGE:
+		return "running average";
+	case GAUSSIAN:
+		return "per-pixel Gaussian";
+	case MIXTURE:
+		return "mixture of Gaussians";
+	default:
+		return "static";
+	}
+}
+
+} /* namespace nl_uu_science_gmt */
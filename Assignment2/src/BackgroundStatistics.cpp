@@ -0,0 +1,226 @@
+/*
+ * BackgroundStatistics.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "BackgroundStatistics.h"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "ColorSpace.h"
+#include "General.h"
+#include "SeekIndex.h"
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+const uint32_t BackgroundStatistics::MAGIC = 0x54534742;  // "BGST"
+const int32_t BackgroundStatistics::VERSION = 3;  // 2: circular hue, BGR mean; 3: modification time, first frame
+
+/**
+ * Get the HSV mean and standard deviation (both CV_8UC3) of the background video 'video_path',
+ * and its BGR mean (for the other color spaces), from the statistics file 'cache_path' if it
+ * belongs to this video, otherwise build and save them
+ */
+bool BackgroundStatistics::obtain(const string &video_path, const string &cache_path, Mat &mean, Mat &stddev,
+		Mat &bgr_mean)
+{
+	const int64_t video_bytes = General::fsize(video_path);
+	const int64_t video_time = General::fmtime(video_path);
+	if (video_bytes <= 0) return false;
+	if (load(cache_path, video_path, video_bytes, video_time, mean, stddev, bgr_mean)) return true;
+
+	cout << "Building the background statistics of " << video_path << "..." << flush;
+	int frames = 0;
+	uint64_t first_hash = 0;
+	if (!build(video_path, mean, stddev, bgr_mean, frames, first_hash))
+	{
+		cout << " failed!" << endl;
+		return false;
+	}
+	cout << " " << frames << " frames" << endl;
+
+	if (!save(cache_path, video_bytes, video_time, first_hash, frames, mean, stddev, bgr_mean))
+		cout << "Unable to write: " << cache_path << endl;
+	return true;
+}
+
+/**
+ * Stream all frames of the video and accumulate the per-pixel sums and squared sums of
+ * H, S and V (the rows of a frame in parallel), then turn them into the mean and standard
+ * deviation. The sums are exact integers, so the result doesn't depend on the thread count.
+ *
+ * Hue is circular (0 and 179 are neighbors), so it's accumulated as the difference to the
+ * pixel's hue in the first frame, wrapped to [-90, 90). Its mean is that reference plus the
+ * mean difference (wrapped to [0, 180)), its deviation that of the differences. That's exact
+ * as long as a pixel's hues stay within half the circle, which a background pixel's do.
+ *
+ * The BGR sums give the BGR mean, of which the other (linear) color spaces take their mean.
+ * 'first_hash' is the hash of the first frame (SeekIndex::hashFrame), to recognize the video.
+ */
+bool BackgroundStatistics::build(const string &video_path, Mat &mean, Mat &stddev, Mat &bgr_mean, int &frames,
+		uint64_t &first_hash)
+{
+	VideoCapture video(video_path);
+	if (!video.isOpened()) return false;
+
+	vector<int32_t> sums;
+	vector<uint64_t> squares;
+	vector<uint32_t> bgr_sums;
+	vector<uchar> reference_hues;
+	Size size;
+	Mat frame;
+	frames = 0;
+
+	while (video.read(frame) && !frame.empty())
+	{
+		if (frames == 0)
+		{
+			size = frame.size();
+			sums.assign(size.area() * 3, 0);
+			squares.assign(size.area() * 3, 0);
+			bgr_sums.assign(size.area() * 3, 0);
+			reference_hues.assign(size.area(), 0);
+			first_hash = SeekIndex::hashFrame(frame);
+		}
+		if (frame.size() != size || frame.type() != CV_8UC3) break;
+		const bool first = frames == 0;
+
+#ifdef PARALLEL_PROCESS
+#pragma omp parallel for //schedule(static)
+#endif
+		for (int y = 0; y < size.height; ++y)
+		{
+			const uchar* bgr = frame.ptr<uchar>(y);
+			int32_t* sum = &sums[y * size.width * 3];
+			uint64_t* square = &squares[y * size.width * 3];
+			uint32_t* bgr_sum = &bgr_sums[y * size.width * 3];
+			uchar* reference_hue = &reference_hues[y * size.width];
+
+			for (int x = 0; x < size.width; ++x, bgr += 3, sum += 3, square += 3, bgr_sum += 3, ++reference_hue)
+			{
+				int hsv[3];
+				ColorSpace::bgrToHsv(bgr[0], bgr[1], bgr[2], hsv[0], hsv[1], hsv[2]);
+				if (first) *reference_hue = (uchar) (hsv[0] % 180);
+
+				hsv[0] = (hsv[0] - *reference_hue + 270) % 180 - 90;
+				for (int c = 0; c < 3; ++c)
+				{
+					sum[c] += hsv[c];
+					square[c] += hsv[c] * hsv[c];
+					bgr_sum[c] += bgr[c];
+				}
+			}
+		}
+		++frames;
+	}
+	if (frames == 0) return false;
+
+	mean.create(size, CV_8UC3);
+	stddev.create(size, CV_8UC3);
+	bgr_mean.create(size, CV_8UC3);
+	for (int y = 0; y < size.height; ++y)
+	{
+		uchar* m = mean.ptr<uchar>(y);
+		uchar* d = stddev.ptr<uchar>(y);
+		uchar* b = bgr_mean.ptr<uchar>(y);
+		const size_t row = (size_t) y * size.width * 3;
+
+		for (int i = 0; i < size.width * 3; ++i)
+		{
+			const double average = (double) sums[row + i] / frames;
+			const double variance = (double) squares[row + i] / frames - average * average;
+			d[i] = saturate_cast<uchar>(sqrt(max(0.0, variance)));
+			b[i] = saturate_cast<uchar>((double) bgr_sums[row + i] / frames);
+			if (i % 3 == 0)
+			{
+				const int hue = cvRound(reference_hues[row / 3 + i / 3] + average);
+				m[i] = (uchar) ((hue + 180) % 180);
+			}
+			else
+			{
+				m[i] = saturate_cast<uchar>(average);
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Read the statistics file, if it was made from the video 'video_path' of 'video_bytes' bytes,
+ * last modified at 'video_time', and that video still starts with the same frame
+ */
+bool BackgroundStatistics::load(const string &cache_path, const string &video_path, int64_t video_bytes,
+		int64_t video_time, Mat &mean, Mat &stddev, Mat &bgr_mean)
+{
+	ifstream file(cache_path.c_str(), ios::binary);
+	if (!file.is_open()) return false;
+
+	uint32_t magic = 0;
+	int32_t version = 0, width = 0, height = 0, frames = 0;
+	int64_t source_bytes = 0, source_time = 0;
+	uint64_t first_hash = 0;
+	file.read((char*) &magic, sizeof(magic));
+	file.read((char*) &version, sizeof(version));
+	file.read((char*) &width, sizeof(width));
+	file.read((char*) &height, sizeof(height));
+	file.read((char*) &frames, sizeof(frames));
+	file.read((char*) &source_bytes, sizeof(source_bytes));
+	file.read((char*) &source_time, sizeof(source_time));
+	file.read((char*) &first_hash, sizeof(first_hash));
+	if (!file || magic != MAGIC || version != VERSION || source_bytes != video_bytes || source_time != video_time
+			|| width <= 0 || height <= 0) return false;
+
+	// A video re-recorded to the same size within the same second still differs in its first frame
+	VideoCapture video(video_path);
+	Mat frame;
+	if (!video.read(frame) || frame.empty() || SeekIndex::hashFrame(frame) != first_hash) return false;
+
+	Mat* images[] = { &mean, &stddev, &bgr_mean };
+	for (int i = 0; i < 3; ++i)
+	{
+		images[i]->create(height, width, CV_8UC3);
+		for (int y = 0; y < height; ++y)
+			file.read((char*) images[i]->ptr<uchar>(y), width * 3);
+	}
+	return (bool) file;
+}
+
+/**
+ * Write the statistics file: a header (identifying the video by its size in bytes, its
+ * modification time and the hash of its first frame), followed by the HSV mean, the HSV
+ * standard deviation and the BGR mean images
+ */
+bool BackgroundStatistics::save(const string &cache_path, int64_t video_bytes, int64_t video_time,
+		uint64_t first_hash, int frames, const Mat &mean, const Mat &stddev, const Mat &bgr_mean)
+{
+	assert(mean.type() == CV_8UC3 && stddev.type() == CV_8UC3 && bgr_mean.type() == CV_8UC3);
+	assert(mean.size() == stddev.size() && mean.size() == bgr_mean.size());
+
+	ofstream file(cache_path.c_str(), ios::binary);
+	if (!file.is_open()) return false;
+
+	const int32_t width = mean.cols, height = mean.rows, frames32 = frames;
+	file.write((const char*) &MAGIC, sizeof(MAGIC));
+	file.write((const char*) &VERSION, sizeof(VERSION));
+	file.write((const char*) &width, sizeof(width));
+	file.write((const char*) &height, sizeof(height));
+	file.write((const char*) &frames32, sizeof(frames32));
+	file.write((const char*) &video_bytes, sizeof(video_bytes));
+	file.write((const char*) &video_time, sizeof(video_time));
+	file.write((const char*) &first_hash, sizeof(first_hash));
+	const Mat* images[] = { &mean, &stddev, &bgr_mean };
+	for (int i = 0; i < 3; ++i)
+		for (int y = 0; y < height; ++y)
+			file.write((const char*) images[i]->ptr<uchar>(y), width * 3);
+	return (bool) file;
+}
+
+} /* namespace nl_uu_science_gmt */
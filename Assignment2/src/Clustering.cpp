@@ -8,8 +8,8 @@ namespace nl_uu_science_gmt
 /*
 *  Make a voxel clustering with _K clusters.
 */
-Clustering::Clustering(Scene3DRenderer& scene3d, int K, bool initialOnly) :
-	_scene3d(scene3d), _K(K), _show_initial(initialOnly)
+Clustering::Clustering(Scene3DRenderer& scene3d, int K, bool initialOnly, bool show) :
+	_scene3d(scene3d), _K(K), _show_initial(initialOnly), _show(show)
 {
 	//Only voxels of (approximately) torso height are used for the color models,
 	// and for the inital labeling in each tracking step.
@@ -34,6 +34,20 @@ Clustering::Clustering(Scene3DRenderer& scene3d, int K, bool initialOnly) :
 
 	//Keep the camera's stored for future use
 	_cams = _scene3d.getCameras();
+
+	//Size the per-frame buffers for every coarse voxel visible, so processFrame doesn't allocate
+	//  (refined sub-voxels can outnumber them, then the buffers grow: refinement allocates)
+	const int voxels = (int) _scene3d.getReconstructor().getVoxels().size();
+	_frames.resize(_cams.size());
+	_voxel_data.create(voxels, 2, CV_32F);
+	_labels.reserve(voxels);
+	_voxel_colors.reserve(_cams.size());
+	_divergence.reserve(_K);
+	_average.reserve(_K);
+	_new_average.reserve(_K);
+	_initial_centers.resize(_K);
+	_cam_to_center.resize(_K);
+
 	initializeColorModel();
 
 	//To write the cluster center position to a text file, for the entire video,
@@ -153,11 +167,11 @@ void Clustering::initializeColorModel()
 		//Check if the clustering attempt succeeded
 		if (isLocalMinimum(centers))
 		{
-			imshow("Attempt resulted in local minimum" + attempt, clusterImage);
+			if (_show) imshow("Attempt resulted in local minimum" + attempt, clusterImage);
 		}
 		else
 		{
-			imshow("Successful initial clustering", clusterImage);
+			if (_show) imshow("Successful initial clustering", clusterImage);
 			break;
 		}
 	}
@@ -192,7 +206,7 @@ void Clustering::initializeColorModel()
 		//Use a Hue Histogram as color model
 		_models.push_back(ColorHistogram(getVoxelColorsBunchedHSV(clusters[m]), 30, m));	
 		//Visualize the color models, so we know what we are working with
-		_models[m].visualisationImage();
+		if (_show) _models[m].visualisationImage();
 	}
 
 }
@@ -202,53 +216,48 @@ void Clustering::initializeColorModel()
 //The result is that each voxel will have received the color attribute of its corresponding cluster.
 //Voxels colored gray have not been classified (e.g. when doing only the initial labeling round).
 //Returns the cluster centers.
-vector<Point2f> Clustering::processFrame()
+//All intermediate containers are members that keep their capacity, so a frame doesn't allocate.
+const vector<Point2f>& Clustering::processFrame()
 {
 	//Take the visible voxels for this frame
-	vector<Reconstructor::Voxel*> voxels = _scene3d.getReconstructor().getVisibleVoxels();
+	const vector<Reconstructor::Voxel*> &voxels = _scene3d.getReconstructor().getVisibleVoxels();
 	processOcclusions(voxels);
 		
 	//Get the current frames of the cameras, in HSV, to determine voxel colors
-	vector<Mat> BGRframes (_cams.size());
-	vector<Mat> frames (_cams.size());
+	//(converted once per frame on the camera and shared between the stages; the voxels
+	//only project within the volume's projection, the frame isn't needed beyond it)
 	for (int c = 0; c < _cams.size(); c++)
 	{
-		BGRframes[c] = _cams[c]->getFrame();
-		//Convert each frame from BGR to HSV
-		frames[c] = BGRframes[c].clone();
-		cvtColor(frames[c], frames[c], CV_BGR2HSV);
+		_frames[c] = _cams[c]->getHsvFrame(&_cams[c]->getVolumeSpans());
 	}
 	
 	//Start putting the 2d voxel position in a matrix, this can be used for kmeans (if desired)
-	Mat voxeldata = Mat::zeros(voxels.size(), 2, CV_32F);
-	Mat centers;
-	vector<int> labels = vector<int>(voxels.size());
+	//The matrix only grows, a view of the used rows is taken
+	if (_voxel_data.rows < (int) voxels.size())
+	{
+		_voxel_data.create(max((int) voxels.size(), 2 * _voxel_data.rows), 2, CV_32F);
+	}
+	Mat voxeldata = _voxel_data.rowRange(0, (int) voxels.size());
+	_labels.assign(voxels.size(), 0);
 
 	//The third dimension of average is used for the amount of samples over which the average is taken
-	vector<Point3i> average;
 	//Start calculating the center (avg position in 2d) of each of the clusters
-	for (int i=0; i<_K; i++)
-	{
-		average.push_back(Point3i(0,0,0));
-	}
+	_average.assign(_K, Point3i(0,0,0));
 
 	//Compare voxels to color models	
 	for(int v = 0; v < voxels.size(); v++)
 	{
 		//Take voxel 2d position
-		Point2f position = Point2f((float) voxels[v]->x, (float) voxels[v]->y);
-		float data[2] = { (float) position.x, (float) position.y };
-		Mat point(1, 2, CV_32F, &data);
-		//Add the row values to the (zero-initialized) matrix, simply using '=' won't work
-		voxeldata.row(v) += point;
-		vector<float> divergence;
+		voxeldata.at<float>(v, 0) = (float) voxels[v]->x;
+		voxeldata.at<float>(v, 1) = (float) voxels[v]->y;
+		_divergence.clear();
 
 		//Get the (HSV) colors belonging to the voxel
-		vector<Scalar> voxelColors = getVoxelColors(voxels[v], v, frames);
+		getVoxelColors(voxels[v], v, _frames, _voxel_colors);
 
 		//If for some reason no colors are returned (completely occluded or wrong height),
 		// don't use the voxel for initial labeling and make it gray.
-		if (voxelColors.empty())
+		if (_voxel_colors.empty())
 		{
 			voxels[v]->color = unlabeledColor;
 			voxels[v]->cluster = -1;
@@ -258,15 +267,15 @@ vector<Point2f> Clustering::processFrame()
 			//Compare the voxel colos to each color model
 			for (int k = 0; k< _K; k++)
 			{
-				int size = voxelColors.size();
+				int size = _voxel_colors.size();
 				float count = 0;
 				for (int c =0; c<size; c++)
 				{
-					count += _models[k].distanceTo(voxelColors[c]); 
+					count += _models[k].distanceTo(_voxel_colors[c]); 
 				}
 
 				float averageDivergence = count/size;
-				divergence.push_back(averageDivergence);
+				_divergence.push_back(averageDivergence);
 			}
 			//Find the index of the color model that fits best
 			int index = 0;
@@ -274,29 +283,28 @@ vector<Point2f> Clustering::processFrame()
 			
 			for (int i=0; i<_K; i++)
 			{	
-				if (divergence[i] < lowestdivergence){
+				if (_divergence[i] < lowestdivergence){
 					index = i;
-					lowestdivergence = divergence[i];
+					lowestdivergence = _divergence[i];
 				}
 			}
-			labels[v] = index;
+			_labels[v] = index;
 
 			//Set the voxel color
 			voxels[v]->color = drawcolors[index];
 			voxels[v]->cluster = index;
 
-			average[index] += Point3i(voxels[v]->x, voxels[v]->y, 1);
+			_average[index] += Point3i(voxels[v]->x, voxels[v]->y, 1);
 		}
 			
 	}
 
 	//Calculate the initial cluster centers
-	vector<Point2f> initialCenters;
 	for (int i = 0; i < _K; i++)
 	{
-		float avgX = (float) average[i].x / (float) average[i].z;
-		float avgY = (float) average[i].y / (float) average[i].z;
-		initialCenters.push_back( Point2f(avgX, avgY) );
+		float avgX = (float) _average[i].x / (float) _average[i].z;
+		float avgY = (float) _average[i].y / (float) _average[i].z;
+		_initial_centers[i] = Point2f(avgX, avgY);
 	}
 
 
@@ -304,18 +312,14 @@ vector<Point2f> Clustering::processFrame()
 
 	if (_show_initial)
 	{
-		_prev_centers = vector<Point2f>(initialCenters);
-		return initialCenters;
+		_prev_centers = _initial_centers;
+		return _prev_centers;
 	}
 
 
 	//Get ready to calculate new cluster centers
 	//The third dimension of newAverage is used for the amount of samples over which the average is taken
-	vector<Point3i> newAverage;	
-	for (int i=0; i<_K; i++)
-	{
-		newAverage.push_back(Point3i(0,0,0));
-	}
+	_new_average.assign(_K, Point3i(0,0,0));
 
 	//Do a round of (re-)labeling the voxels to the closest initial cluster center
 	for (int v = 0; v < voxels.size(); v++)
@@ -327,35 +331,34 @@ vector<Point2f> Clustering::processFrame()
 		for (int i=0; i<_K; i++)
 		{
 			//Check if this center is closer, using Euclidean distance in the x-y plane
-			if (norm(initialCenters[i] - position) < shortestDistance)
+			if (norm(_initial_centers[i] - position) < shortestDistance)
 			{
 				closestCenter = i;
-				shortestDistance = norm(initialCenters[i] - position);
+				shortestDistance = norm(_initial_centers[i] - position);
 			}
 		}
 
 		//Re-label
-		//labels[v] = closestCenter;
+		//_labels[v] = closestCenter;
 		//Re-set the voxel color
 		voxels[v]->color = drawcolors[closestCenter];
 		voxels[v]->cluster = closestCenter;
 		//Start calculating the new cluster centers
-		newAverage[closestCenter] += Point3i(voxels[v]->x, voxels[v]->y, 1);
+		_new_average[closestCenter] += Point3i(voxels[v]->x, voxels[v]->y, 1);
 	}
 
 	//Now recalculate the cluster centers
 	for (int i=0; i<_K; i++)
 	{
-		float avgX = (float) newAverage[i].x / (float) newAverage[i].z;
-		float avgY = (float) newAverage[i].y / (float) newAverage[i].z;
-		centers.push_back( Point2f(avgX, avgY) );
+		float avgX = (float) _new_average[i].x / (float) _new_average[i].z;
+		float avgY = (float) _new_average[i].y / (float) _new_average[i].z;
+		_prev_centers[i] = Point2f(avgX, avgY);
 	}
 
 	///Finally, it is possible to add a few extra iteration of kmeans (simply uncomment the next line)
-	//kmeans(voxeldata,_K,labels,TermCriteria(CV_TERMCRIT_ITER, 3, 1.0), 2, KMEANS_USE_INITIAL_LABELS, centers);
+	//kmeans(voxeldata,_K,_labels,TermCriteria(CV_TERMCRIT_ITER, 3, 1.0), 2, KMEANS_USE_INITIAL_LABELS, centers);
 	
-	_prev_centers = vector<Point2f>(centers);
-	return centers;
+	return _prev_centers;
 }
 
 
@@ -433,14 +436,15 @@ bool Clustering::isLocalMinimum(Mat& centers)
 //If a line from a voxel to the camera intersects with ANOTHER person, it is occluded for that camera.
 //The result is a rough estimation, where 'inner body voxels' are not occluded by their own cylinder, but this is not a big problem,
 //  because they belong to the same person as the 'skin-level voxels' anyway.
-void Clustering::processOcclusions(vector<Reconstructor::Voxel*> voxels)
+void Clustering::processOcclusions(const vector<Reconstructor::Voxel*> &voxels)
 {
+	vector<Point2f> &camToCenter = _cam_to_center;
+
 	//Determine occlusions for each camera
 	for (int c = 0; c < _cams.size(); c++)
 	{
 		//Calculate the (2d) vector from camera to each cluster center.
 		Point2f camPosition = Point2f(_cams[c]->getCameraLocation().x, _cams[c]->getCameraLocation().y);
-		vector<Point2f> camToCenter = vector<Point2f>(_K);
 		for (int i = 0; i < _K; i++)
 		{
 			camToCenter[i] = _prev_centers[i] - camPosition;
@@ -489,17 +493,18 @@ void Clustering::processOcclusions(vector<Reconstructor::Voxel*> voxels)
 
 //Determines the voxel's corresponding pixel colors,
 //  found on the given frames (one for each camera).
-vector<Scalar> Clustering::getVoxelColors(Reconstructor::Voxel* voxel, int voxelNr, vector<Mat> frames)
+//The colors are written to the given vector, so its capacity can be reused between voxels.
+void Clustering::getVoxelColors(Reconstructor::Voxel* voxel, int voxelNr, const vector<Mat> &frames, vector<Scalar> &colors)
 {
+	//Pixel colors for this voxel
+	colors.clear();
+
 	//Only the colors of torso-height voxels are used, because those have distinctive colors
 	if ((voxel->z < _min_z) || (voxel->z > _max_z))
 	{
-		return vector<Scalar>();
+		return;
 	}
 
-	//Pixel colors for this voxel
-	vector<Scalar> colors;
-
 	for (int c = 0; c < frames.size(); c++)
 	{
 		//Check if the voxel is within the camera angle and not occluded
@@ -510,26 +515,19 @@ vector<Scalar> Clustering::getVoxelColors(Reconstructor::Voxel* voxel, int voxel
 			colors.push_back(Scalar(values[0], values[1], values[2]));
 		}
 	}
-
-	return colors;
 }
 
 
 //Determines the voxels' corresponding pixel colors (just like getVoxelColorsBGR),
-//  but returns all BGR color values bunched together in a single vector.
+//  but returns all HSV color values bunched together in a single vector.
 //This is more useful for building a color model, instead of tracking single voxels.
-//Contains an extra conversion step to go from BGR to HSV
 vector<Scalar> Clustering::getVoxelColorsBunchedHSV(vector<Reconstructor::Voxel*> voxels)
 {
-	//First, get the current frames of the cameras, in HSV
-	vector<Mat> BGRframes (_cams.size());
+	//First, get the current frames of the cameras, in HSV (already converted once per frame on the camera)
 	vector<Mat> frames (_cams.size());
 	for (int c = 0; c < _cams.size(); c++)
 	{
-		BGRframes[c] = _cams[c]->getFrame();
-		//Convert each frame from BGR to HSV, to get HSV values for the voxels
-		frames[c] = BGRframes[c].clone();
-		cvtColor(frames[c], frames[c], CV_BGR2HSV);
+		frames[c] = _cams[c]->getHsvFrame(&_cams[c]->getVolumeSpans());
 	}
 
 
@@ -0,0 +1,171 @@
+/*
+ * FrameBundleSource.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "FrameBundleSource.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+const int FrameBundleSource::MAX_SKIP = 8;
+
+FrameBundleSource::FrameBundleSource(const vector<Camera*> &cameras) :
+		_cameras(cameras), _policy(REPEAT), _threads((int) cameras.size())
+{
+	reset();
+}
+
+/**
+ * Forget the last frames and the statistics
+ */
+void FrameBundleSource::reset()
+{
+	_last.assign(_cameras.size(), Mat());
+	_last_index.assign(_cameras.size(), -1);
+	_missing.assign(_cameras.size(), 0);
+	_repeated = 0;
+	_skipped = 0;
+	_dropped = 0;
+}
+
+/**
+ * Decode frame 'index' on all cameras, one task per camera. True if none missed it.
+ */
+bool FrameBundleSource::decode(int index)
+{
+#ifdef PARALLEL_PROCESS
+#pragma omp parallel for schedule(dynamic, 1) num_threads(max(1, _threads))
+#endif
+	for (int c = 0; c < (int) _cameras.size(); ++c)
+	{
+		Camera* camera = _cameras[c];
+		const Mat &frame = camera->getNextFrame() == index ? camera->advanceVideoFrame() : camera->getVideoFrame(index);
+		_missing[c] = frame.empty();
+	}
+	return count(_missing.begin(), _missing.end(), 1) == 0;
+}
+
+/**
+ * Put the last good frame back on every camera (a black frame if there's none yet), as
+ * 'sources' tells. A camera that missed its frame still holds the only reference to its last
+ * frame, the others decoded over it, so those decode it again. A live camera can't go back,
+ * it keeps its new frame.
+ */
+void FrameBundleSource::restore(vector<int> &sources)
+{
+#ifdef PARALLEL_PROCESS
+#pragma omp parallel for schedule(dynamic, 1) num_threads(max(1, _threads))
+#endif
+	for (int c = 0; c < (int) _cameras.size(); ++c)
+	{
+		Camera* camera = _cameras[c];
+		if (_last_index[c] < 0)
+			camera->setFrame(Mat::zeros(camera->getSize(), CV_8UC3));
+		else if (_missing[c])
+			camera->setFrame(_last[c]);
+		else if (camera->isSeekable())
+			_last[c] = camera->getVideoFrame(_last_index[c]);
+		else
+			_last_index[c] = camera->getNextFrame() - 1;
+		sources[c] = _last_index[c];
+	}
+}
+
+/**
+ * Read frame 'index' from all cameras into 'bundle', applying the missing frame policy when
+ * a camera doesn't have it. False if there's no bundle (then the cameras keep their last
+ * frames, and 'bundle' only tells the frame number that was tried).
+ */
+bool FrameBundleSource::read(int index, FrameBundle &bundle)
+{
+	if (_last.size() != _cameras.size()) reset();
+
+	bool complete = decode(index);
+	if (!complete && _policy == SKIP)
+	{
+		for (int s = 0; s < MAX_SKIP && !complete && index + 1 < getFramesAmount(); ++s)
+		{
+			complete = decode(++index);
+			++_skipped;
+		}
+	}
+
+	bundle.index = index;
+	bundle.complete = complete;
+	bundle.sources.resize(_cameras.size());
+	bundle.frames.resize(_cameras.size());
+
+	bool delivered = true;
+	if (!complete && _policy != REPEAT)
+	{
+		restore(bundle.sources);
+		++_dropped;
+		delivered = false;
+	}
+	else
+	{
+		for (size_t c = 0; c < _cameras.size(); ++c)
+		{
+			if (!_missing[c])
+			{
+				// Shares the camera's frame: the next decode overwrites it, unless the camera misses
+				// that frame, then this is the only reference left
+				_last[c] = _cameras[c]->getFrame();
+				_last_index[c] = _cameras[c]->getNextFrame() - 1;  // 'index', unless numbered by a live producer
+			}
+			else if (_last_index[c] >= 0)
+			{
+				_cameras[c]->setFrame(_last[c]);
+				++_repeated;
+			}
+			else
+			{
+				_cameras[c]->setFrame(Mat::zeros(_cameras[c]->getSize(), CV_8UC3));
+				++_repeated;
+			}
+			bundle.sources[c] = _last_index[c];
+		}
+	}
+
+	for (size_t c = 0; c < _cameras.size(); ++c)
+		bundle.frames[c] = _cameras[c]->getFrame();
+	bundle.timestamp = _cameras.empty() ? 0 : _cameras.front()->getTimestamp();
+	return delivered;
+}
+
+/**
+ * The amount of frames of the longest video, the shorter ones miss the frames beyond their end
+ */
+long FrameBundleSource::getFramesAmount() const
+{
+	long frames = 0;
+	for (size_t c = 0; c < _cameras.size(); ++c)
+		frames = max(frames, _cameras[c]->getFramesAmount());
+	return frames;
+}
+
+/**
+ * Name of a missing frame policy
+ */
+const char* FrameBundleSource::getPolicyName(MissingPolicy policy)
+{
+	switch (policy)
+	{
+	case REPEAT:
+		return "repeat";
+	case SKIP:
+		return "skip";
+	case DROP:
+		return "drop";
+	}
+	return "";
+}
+
+} /* namespace nl_uu_science_gmt */
@@ -0,0 +1,133 @@
+/*
+ * FrameCache.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "FrameCache.h"
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * An empty cache of at most 'max_bytes' bytes
+ */
+FrameCache::FrameCache(size_t max_bytes) :
+		_max_bytes(max_bytes), _bytes(0), _hits(0), _misses(0)
+{
+}
+
+/**
+ * The entry of the given frame (marked as most recently used), NULL if it isn't cached
+ */
+FrameCache::Entry* FrameCache::find(int frame)
+{
+	map<int, list<Entry>::iterator>::iterator it = _index.find(frame);
+	if (it == _index.end()) return NULL;
+
+	_entries.splice(_entries.begin(), _entries, it->second);
+	return &_entries.front();
+}
+
+/**
+ * The entry of the given frame to fill, an existing one or a new one (recycling the
+ * buffers of the last evicted entry). Call commit() once it's filled.
+ */
+FrameCache::Entry& FrameCache::insert(int frame)
+{
+	Entry* existing = find(frame);
+	if (existing != NULL) return *existing;
+
+	if (!_spare.empty())
+		_entries.splice(_entries.begin(), _spare, _spare.begin());
+	else
+		_entries.push_front(Entry());
+
+	Entry &entry = _entries.front();
+	entry.frame = frame;
+	entry.derived = false;
+	entry.bytes = 0;
+	_index[frame] = _entries.begin();
+	return entry;
+}
+
+/**
+ * Account for the (re)filled entry and evict entries until the cache fits its budget again
+ */
+void FrameCache::commit(Entry &entry)
+{
+	_bytes -= entry.bytes;
+	entry.bytes = measure(entry);
+	_bytes += entry.bytes;
+	evict(entry.frame);
+}
+
+/**
+ * Evict the least recently used entries until the cache fits, sparing the entries of
+ * 'current' and its neighbors if possible. The last entry is always kept.
+ */
+void FrameCache::evict(int current)
+{
+	while (_bytes > _max_bytes && _entries.size() > 1)
+	{
+		list<Entry>::iterator victim = _entries.end();
+		for (list<Entry>::iterator it = _entries.end(); it != _entries.begin();)
+		{
+			--it;
+			if (abs(it->frame - current) > 1)
+			{
+				victim = it;
+				break;
+			}
+			if (victim == _entries.end() && it->frame != current) victim = it;
+		}
+		if (victim == _entries.end()) victim = --_entries.end();
+
+		_index.erase(victim->frame);
+		_bytes -= victim->bytes;
+		if (_spare.empty())
+			_spare.splice(_spare.begin(), _entries, victim);
+		else
+			_entries.erase(victim);
+	}
+}
+
+/**
+ * Drop all entries
+ */
+void FrameCache::clear()
+{
+	_entries.clear();
+	_index.clear();
+	_spare.clear();
+	_bytes = 0;
+}
+
+/**
+ * The memory an entry holds on to
+ */
+size_t FrameCache::measure(const Entry &entry)
+{
+	size_t bytes = sizeof(Entry);
+	for (size_t c = 0; c < entry.frames.size(); ++c)
+		bytes += entry.frames[c].total() * entry.frames[c].elemSize();
+	for (size_t c = 0; c < entry.foregrounds.size(); ++c)
+		bytes += entry.foregrounds[c].total() * entry.foregrounds[c].elemSize();
+	bytes += entry.visible_voxels.capacity() * sizeof(Reconstructor::Voxel*);
+	bytes += entry.colors.capacity() * sizeof(Scalar);
+	bytes += entry.clusters.capacity() * sizeof(int);
+	return bytes;
+}
+
+/**
+ * Combine a parameter value into a parameter hash
+ */
+size_t FrameCache::hash(size_t seed, int value)
+{
+	return seed ^ ((size_t) value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+} /* namespace nl_uu_science_gmt */
@@ -0,0 +1,100 @@
+/*
+ * FrameRingProducer.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Reference producer for the shared memory frame input: replays the cameras' videos into
+ * their rings at the videos' frame rate, as a capture process would deliver its frames.
+ *
+ * Usage: FrameRingProducer [data path (data/)] [amount of cameras (4)] [--once]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+#include "General.h"
+#include "SharedFrameRing.h"
+
+using namespace nl_uu_science_gmt;
+using namespace std;
+using namespace cv;
+
+int main(int argc, char** argv)
+{
+	const string data_path = argc > 1 ? argv[1] : "data" + string(PATH_SEP);
+	const int cameras = argc > 2 ? atoi(argv[2]) : 4;
+	const bool once = argc > 3 && strcmp(argv[3], "--once") == 0;
+	const int slots = 4;
+
+	vector<VideoCapture> videos(cameras);
+	vector<SharedFrameRing*> rings(cameras);
+	double fps = 0;
+	for (int c = 0; c < cameras; ++c)
+	{
+		stringstream video_path;
+		video_path << data_path << "cam" << (c + 1) << PATH_SEP << General::VideoFile;
+		videos[c].open(video_path.str());
+		if (!videos[c].isOpened())
+		{
+			cerr << "Unable to read: " << video_path.str() << endl;
+			return EXIT_FAILURE;
+		}
+		if (fps <= 0) fps = videos[c].get(CV_CAP_PROP_FPS);
+
+		const Size size((int) videos[c].get(CV_CAP_PROP_FRAME_WIDTH), (int) videos[c].get(CV_CAP_PROP_FRAME_HEIGHT));
+		rings[c] = new SharedFrameRing();
+		if (!rings[c]->create(SharedFrameRing::getName(c), size, slots))
+		{
+			cerr << "Unable to create: " << SharedFrameRing::getName(c) << endl;
+			return EXIT_FAILURE;
+		}
+	}
+	if (fps <= 0) fps = 25;
+	cout << "Replaying " << cameras << " videos at " << fps << " fps, hit Ctrl+C to stop" << endl;
+
+	// Every tick, one frame per camera (all cameras with the same frame number)
+	const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	const chrono::duration<double> period(1 / fps);
+	Mat frame;
+	int64_t number = 0;
+	for (int64_t tick = 0;; ++tick)
+	{
+		this_thread::sleep_until(start + chrono::duration_cast<chrono::steady_clock::duration>(period * tick));
+		const double timestamp = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		bool ended = false;
+		for (int c = 0; c < cameras && !ended; ++c)
+		{
+			videos[c] >> frame;
+			if (frame.empty())
+				ended = true;
+			else
+				rings[c]->write(frame, number, timestamp);
+		}
+		++number;
+
+		if (ended)
+		{
+			if (once) break;
+			for (int c = 0; c < cameras; ++c)
+				videos[c].set(CV_CAP_PROP_POS_FRAMES, 0);
+			number = 0;
+		}
+	}
+
+	uint64_t dropped = 0;
+	for (int c = 0; c < cameras; ++c)
+	{
+		dropped += rings[c]->getDropped();
+		delete rings[c];  // finishes the ring
+	}
+	cout << "Done, " << dropped << " frames dropped" << endl;
+	return EXIT_SUCCESS;
+}
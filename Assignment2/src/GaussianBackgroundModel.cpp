@@ -0,0 +1,106 @@
+/*
+ * GaussianBackgroundModel.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "GaussianBackgroundModel.h"
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+const int GaussianBackgroundModel::INITIAL_VARIANCE = (5 * 5) << 8;
+const int GaussianBackgroundModel::MINIMUM_VARIANCE = (2 * 2) << 8;
+
+GaussianBackgroundModel::GaussianBackgroundModel(const Mat &bg_hsv_image) :
+		BackgroundModel(GAUSSIAN, bg_hsv_image.size())
+{
+	assert(bg_hsv_image.type() == CV_8UC3);
+
+	_mean.resize(_size.area() * 3);
+	_variance.assign(_size.area() * 3, INITIAL_VARIANCE);
+	for (int y = 0; y < _size.height; ++y)
+	{
+		const uchar* bg_hsv = bg_hsv_image.ptr<uchar>(y);
+		int* mean = &_mean[y * _size.width * 3];
+		for (int i = 0; i < _size.width * 3; ++i)
+			mean[i] = bg_hsv[i] << 8;
+	}
+}
+
+GaussianBackgroundModel::~GaussianBackgroundModel()
+{
+}
+
+/**
+ * Segment the HSV frame against the per-pixel Gaussians and, when learning,
+ * update the mean and variance of the background pixels
+ */
+void GaussianBackgroundModel::apply(const Mat &hsv_image, int h_threshold, int s_threshold, int v_threshold,
+		bool learn, Mat &foreground)
+{
+	assert(hsv_image.type() == CV_8UC3 && hsv_image.size() == _size);
+
+	foreground.create(_size, CV_8U);
+
+	// Squared thresholds, with the same 8 fractional bits as the variance
+	const int thresholds[3] = { (h_threshold * h_threshold) << 8, (s_threshold * s_threshold) << 8, (v_threshold
+			* v_threshold) << 8 };
+	const int shift = _learning_shift;
+
+	for (int y = 0; y < _size.height; ++y)
+	{
+		const uchar* hsv = hsv_image.ptr<uchar>(y);
+		int* mean = &_mean[y * _size.width * 3];
+		int* variance = &_variance[y * _size.width * 3];
+		uchar* mask = foreground.ptr<uchar>(y);
+
+		for (int x = 0; x < _size.width; ++x, hsv += 3, mean += 3, variance += 3)
+		{
+			int distance[3], squared[3];
+			bool differs[3];
+			for (int c = 0; c < 3; ++c)
+			{
+				distance[c] = (hsv[c] << 8) - mean[c];
+				const int d = distance[c] >> 4;  // 4 fractional bits, so the square has 8
+				squared[c] = d * d;
+
+				// Further than the threshold and 2.5 standard deviations (6.25 = 25 / 4 variances)
+				differs[c] = squared[c] > max(thresholds[c], (variance[c] * 25) >> 2);
+			}
+
+			const bool fg = (differs[0] & differs[1]) | differs[2];
+			mask[x] = fg ? 255 : 0;
+
+			// Only the background adapts, so people standing still aren't absorbed
+			if (learn && !fg)
+			{
+				for (int c = 0; c < 3; ++c)
+				{
+					mean[c] += distance[c] >> shift;
+					variance[c] = max(MINIMUM_VARIANCE, variance[c] + ((squared[c] - variance[c]) >> shift));
+				}
+			}
+		}
+	}
+}
+
+/**
+ * The current background estimate (the means) as an HSV image
+ */
+void GaussianBackgroundModel::getBackground(Mat &bg_hsv_image) const
+{
+	bg_hsv_image.create(_size, CV_8UC3);
+	for (int y = 0; y < _size.height; ++y)
+	{
+		uchar* bg_hsv = bg_hsv_image.ptr<uchar>(y);
+		const int* mean = &_mean[y * _size.width * 3];
+		for (int i = 0; i < _size.width * 3; ++i)
+			bg_hsv[i] = (uchar) ((mean[i] + 128) >> 8);
+	}
+}
+
+} /* namespace nl_uu_science_gmt */
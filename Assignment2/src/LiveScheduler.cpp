@@ -0,0 +1,169 @@
+/*
+ * LiveScheduler.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "LiveScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace nl_uu_science_gmt
+{
+
+// Segmentation, carving, clustering and rendering should be done by these parts of the frame period
+const double LiveScheduler::STAGE_DEADLINES[STAGES] = { 0.5, 0.7, 0.85, 1.0 };
+const double LiveScheduler::REPORT_INTERVAL = 5;
+
+LiveScheduler::LiveScheduler() :
+		_running(false), _period(1 / 25.0), _start_frame(0)
+{
+	reset();
+}
+
+/**
+ * Start the clock: frame 'frame' is due now, the next ones every 1 / 'fps' seconds
+ * (25 fps if the frame rate is unknown)
+ */
+void LiveScheduler::start(int frame, double fps)
+{
+	_running = true;
+	_period = 1 / (fps > 0 ? fps : 25.0);
+	_start = Clock::now();
+	_start_frame = frame;
+	_frame_due = _start;
+}
+
+/**
+ * Stop the clock (eg. when pausing), start() again to continue
+ */
+void LiveScheduler::stop()
+{
+	_running = false;
+}
+
+/**
+ * Clear the statistics
+ */
+void LiveScheduler::reset()
+{
+	_frames = 0;
+	_dropped = 0;
+	fill(_skipped, _skipped + STAGES, 0);
+	fill(_missed, _missed + STAGES, 0);
+	_latency_sum = 0;
+	_latency_max = 0;
+	_report = Clock::now();
+}
+
+/**
+ * The newest frame by the clock
+ */
+int LiveScheduler::getDueFrame() const
+{
+	const double elapsed = chrono::duration<double>(Clock::now() - _start).count();
+	return _start_frame + (int) floor(elapsed / _period);
+}
+
+/**
+ * Count 'frames' stale frames that were dropped
+ */
+void LiveScheduler::drop(long frames)
+{
+	_dropped += max(0L, frames);
+}
+
+/**
+ * Seconds since the current frame was due
+ */
+double LiveScheduler::getElapsed() const
+{
+	return chrono::duration<double>(Clock::now() - _frame_due).count();
+}
+
+/**
+ * Start processing frame 'frame', the deadlines count from when it was due
+ */
+void LiveScheduler::beginFrame(int frame)
+{
+	const chrono::duration<double> offset(_period * (frame - _start_frame));
+	_frame_due = _start + chrono::duration_cast<Clock::duration>(offset);
+	++_frames;
+}
+
+/**
+ * Whether the optional 'stage' may still run for the current frame, false (counted as
+ * skipped) when the frame is past the stage's deadline
+ */
+bool LiveScheduler::admit(Stage stage)
+{
+	const bool in_time = getElapsed() < STAGE_DEADLINES[stage] * _period;
+	if (!in_time) ++_skipped[stage];
+	return in_time;
+}
+
+/**
+ * 'stage' is done for the current frame, count it if that's past its deadline
+ */
+void LiveScheduler::endStage(Stage stage)
+{
+	if (getElapsed() > STAGE_DEADLINES[stage] * _period) ++_missed[stage];
+}
+
+/**
+ * The current frame is done
+ */
+void LiveScheduler::endFrame()
+{
+	const double latency = getElapsed();
+	_latency_sum += latency;
+	_latency_max = max(_latency_max, latency);
+}
+
+/**
+ * Whether it's time to report the statistics again
+ */
+bool LiveScheduler::isReportDue() const
+{
+	return _running && chrono::duration<double>(Clock::now() - _report).count() >= REPORT_INTERVAL;
+}
+
+/**
+ * Write the statistics since the last report, and clear them
+ */
+void LiveScheduler::report(ostream &out)
+{
+	out << "Live: " << _frames << " frames, " << _dropped << " dropped (" << 100 * getDropRatio()
+			<< "%), latency avg " << 1000 * getLatency() << " ms, max " << 1000 * _latency_max << " ms";
+	out << "; deadline misses:";
+	for (int s = 0; s < STAGES; ++s)
+		out << " " << getStageName((Stage) s) << " " << _missed[s];
+	out << "; skipped: " << getStageName(CLUSTERING) << " " << _skipped[CLUSTERING] << ", "
+			<< getStageName(RENDERING) << " " << _skipped[RENDERING] << endl;
+	reset();
+}
+
+/**
+ * Name of a stage
+ */
+const char* LiveScheduler::getStageName(Stage stage)
+{
+	switch (stage)
+	{
+	case SEGMENTATION:
+		return "segmentation";
+	case CARVING:
+		return "carving";
+	case CLUSTERING:
+		return "clustering";
+	case RENDERING:
+		return "rendering";
+	default:
+		return "";
+	}
+}
+
+} /* namespace nl_uu_science_gmt */
@@ -0,0 +1,157 @@
+/*
+ * MixtureBackgroundModel.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "MixtureBackgroundModel.h"
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+const int MixtureBackgroundModel::ONE = 1 << 16;
+const int MixtureBackgroundModel::BACKGROUND_WEIGHT = (7 * ONE) / 10;
+const int MixtureBackgroundModel::INITIAL_VARIANCE = (10 * 10) << 8;
+const int MixtureBackgroundModel::MINIMUM_VARIANCE = (2 * 2) << 8;
+
+MixtureBackgroundModel::MixtureBackgroundModel(const Mat &bg_hsv_image) :
+		BackgroundModel(MIXTURE, bg_hsv_image.size())
+{
+	assert(bg_hsv_image.type() == CV_8UC3);
+
+	// Start with a single mode per pixel: the background image
+	_modes.resize(_size.area() * MODES);
+	for (int y = 0; y < _size.height; ++y)
+	{
+		const uchar* bg_hsv = bg_hsv_image.ptr<uchar>(y);
+		for (int x = 0; x < _size.width; ++x, bg_hsv += 3)
+		{
+			Mode* modes = &_modes[(y * _size.width + x) * MODES];
+			for (int m = 0; m < MODES; ++m)
+			{
+				modes[m].weight = m == 0 ? ONE : 0;
+				modes[m].variance = INITIAL_VARIANCE;
+				for (int c = 0; c < 3; ++c)
+					modes[m].mean[c] = bg_hsv[c] << 8;
+			}
+		}
+	}
+}
+
+MixtureBackgroundModel::~MixtureBackgroundModel()
+{
+}
+
+/**
+ * Segment the HSV frame against the mixtures and, when learning, update them:
+ * the matching mode moves towards the pixel and gains weight, the other modes
+ * lose weight and an unmatched pixel replaces the lightest mode
+ */
+void MixtureBackgroundModel::apply(const Mat &hsv_image, int h_threshold, int s_threshold, int v_threshold,
+		bool learn, Mat &foreground)
+{
+	assert(hsv_image.type() == CV_8UC3 && hsv_image.size() == _size);
+
+	foreground.create(_size, CV_8U);
+
+	// Squared thresholds, with the same 8 fractional bits as the variance
+	const int thresholds[3] = { (h_threshold * h_threshold) << 8, (s_threshold * s_threshold) << 8, (v_threshold
+			* v_threshold) << 8 };
+	const int shift = _learning_shift;
+
+	for (int y = 0; y < _size.height; ++y)
+	{
+		const uchar* hsv = hsv_image.ptr<uchar>(y);
+		uchar* mask = foreground.ptr<uchar>(y);
+
+		for (int x = 0; x < _size.width; ++x, hsv += 3)
+		{
+			Mode* modes = &_modes[(y * _size.width + x) * MODES];
+
+			// Find the heaviest mode that matches the pixel
+			int matched = -1;
+			int distance[3], squared[3];
+			for (int m = 0; m < MODES && matched < 0; ++m)
+			{
+				if (modes[m].weight == 0) break;
+
+				// 2.5 standard deviations (6.25 = 25 / 4 variances)
+				const int noise = (modes[m].variance * 25) >> 2;
+				bool differs[3];
+				for (int c = 0; c < 3; ++c)
+				{
+					distance[c] = (hsv[c] << 8) - modes[m].mean[c];
+					const int d = distance[c] >> 4;  // 4 fractional bits, so the square has 8
+					squared[c] = d * d;
+					differs[c] = squared[c] > max(thresholds[c], noise);
+				}
+
+				if (!((differs[0] & differs[1]) | differs[2])) matched = m;
+			}
+
+			// The pixel is background if it matches one of the modes that make up the first BACKGROUND_WEIGHT
+			bool background = false;
+			if (matched >= 0)
+			{
+				int weight = 0;
+				for (int m = 0; m < matched; ++m)
+					weight += modes[m].weight;
+				background = weight < BACKGROUND_WEIGHT;
+			}
+			mask[x] = background ? 0 : 255;
+
+			if (!learn) continue;
+
+			for (int m = 0; m < MODES; ++m)
+				modes[m].weight -= modes[m].weight >> shift;
+
+			int updated = matched;
+			if (matched >= 0)
+			{
+				Mode &mode = modes[matched];
+				mode.weight += ONE >> shift;
+				for (int c = 0; c < 3; ++c)
+					mode.mean[c] += distance[c] >> shift;
+				const int squared_mean = (squared[0] + squared[1] + squared[2]) / 3;
+				mode.variance = max(MINIMUM_VARIANCE, mode.variance + ((squared_mean - mode.variance) >> shift));
+			}
+			else
+			{
+				// Replace the lightest mode by a new one around the pixel
+				updated = MODES - 1;
+				Mode &mode = modes[updated];
+				mode.weight = ONE >> shift;
+				mode.variance = INITIAL_VARIANCE;
+				for (int c = 0; c < 3; ++c)
+					mode.mean[c] = hsv[c] << 8;
+			}
+
+			// Restore the descending weight order (only the updated mode can have moved up)
+			for (int m = updated; m > 0 && modes[m].weight > modes[m - 1].weight; --m)
+				swap(modes[m], modes[m - 1]);
+		}
+	}
+}
+
+/**
+ * The current background estimate (the heaviest modes) as an HSV image
+ */
+void MixtureBackgroundModel::getBackground(Mat &bg_hsv_image) const
+{
+	bg_hsv_image.create(_size, CV_8UC3);
+	for (int y = 0; y < _size.height; ++y)
+	{
+		uchar* bg_hsv = bg_hsv_image.ptr<uchar>(y);
+		for (int x = 0; x < _size.width; ++x, bg_hsv += 3)
+		{
+			const Mode &mode = _modes[(y * _size.width + x) * MODES];
+			for (int c = 0; c < 3; ++c)
+				bg_hsv[c] = (uchar) ((mode.mean[c] + 128) >> 8);
+		}
+	}
+}
+
+} /* namespace nl_uu_science_gmt */
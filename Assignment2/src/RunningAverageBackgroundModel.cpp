@@ -0,0 +1,87 @@
+/*
+ * RunningAverageBackgroundModel.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "RunningAverageBackgroundModel.h"
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+RunningAverageBackgroundModel::RunningAverageBackgroundModel(const Mat &bg_hsv_image) :
+		BackgroundModel(RUNNING_AVERAGE, bg_hsv_image.size())
+{
+	assert(bg_hsv_image.type() == CV_8UC3);
+
+	_mean.resize(_size.area() * 3);
+	for (int y = 0; y < _size.height; ++y)
+	{
+		const uchar* bg_hsv = bg_hsv_image.ptr<uchar>(y);
+		int* mean = &_mean[y * _size.width * 3];
+		for (int i = 0; i < _size.width * 3; ++i)
+			mean[i] = bg_hsv[i] << 8;
+	}
+}
+
+RunningAverageBackgroundModel::~RunningAverageBackgroundModel()
+{
+}
+
+/**
+ * Segment the HSV frame against the running average and, when learning,
+ * move the average of the background pixels towards the frame
+ */
+void RunningAverageBackgroundModel::apply(const Mat &hsv_image, int h_threshold, int s_threshold, int v_threshold,
+		bool learn, Mat &foreground)
+{
+	assert(hsv_image.type() == CV_8UC3 && hsv_image.size() == _size);
+
+	foreground.create(_size, CV_8U);
+
+	const int shift = _learning_shift;
+	for (int y = 0; y < _size.height; ++y)
+	{
+		const uchar* hsv = hsv_image.ptr<uchar>(y);
+		int* mean = &_mean[y * _size.width * 3];
+		uchar* mask = foreground.ptr<uchar>(y);
+
+		for (int x = 0; x < _size.width; ++x, hsv += 3, mean += 3)
+		{
+			const bool h_fg = abs(hsv[0] - ((mean[0] + 128) >> 8)) > h_threshold;
+			const bool s_fg = abs(hsv[1] - ((mean[1] + 128) >> 8)) > s_threshold;
+			const bool v_fg = abs(hsv[2] - ((mean[2] + 128) >> 8)) > v_threshold;
+			const bool fg = (h_fg & s_fg) | v_fg;
+
+			mask[x] = fg ? 255 : 0;
+
+			// Only the background adapts, so people standing still aren't absorbed
+			if (learn && !fg)
+			{
+				mean[0] += ((hsv[0] << 8) - mean[0]) >> shift;
+				mean[1] += ((hsv[1] << 8) - mean[1]) >> shift;
+				mean[2] += ((hsv[2] << 8) - mean[2]) >> shift;
+			}
+		}
+	}
+}
+
+/**
+ * The current background estimate as an HSV image
+ */
+void RunningAverageBackgroundModel::getBackground(Mat &bg_hsv_image) const
+{
+	bg_hsv_image.create(_size, CV_8UC3);
+	for (int y = 0; y < _size.height; ++y)
+	{
+		uchar* bg_hsv = bg_hsv_image.ptr<uchar>(y);
+		const int* mean = &_mean[y * _size.width * 3];
+		for (int i = 0; i < _size.width * 3; ++i)
+			bg_hsv[i] = (uchar) ((mean[i] + 128) >> 8);
+	}
+}
+
+} /* namespace nl_uu_science_gmt */
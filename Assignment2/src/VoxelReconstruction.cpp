@@ -7,6 +7,12 @@
 
 #include "VoxelReconstruction.h"
 
+#include <chrono>
+#include <thread>
+
+#include "FrameStore.h"
+#include "SharedFrameRing.h"
+
 using namespace nl_uu_science_gmt;
 using namespace std;
 using namespace cv;
@@ -14,6 +20,9 @@ using namespace cv;
 namespace nl_uu_science_gmt
 {
 
+const double VoxelReconstruction::MAX_DROP_RATIO = 0.5;
+const double VoxelReconstruction::MAX_LATENCY_PERIODS = 2;
+
 /**
  * Main constructor, initialized all cameras
  */
@@ -67,19 +76,111 @@ void VoxelReconstruction::showKeys()
 	cout << "i       : Show/hide camera numbers (Linux only)" << endl;
 	cout << "o       : Show/hide origin" << endl;
 	cout << "t       : Top view" << endl;
+	cout << "f       : Cycle sub-voxel refinement (off, 2x, 4x, 8x)" << endl;
+	cout << "m       : Toggle voxel footprint test (instead of center pixel)" << endl;
+	cout << "k       : Toggle bit-packed foreground masks" << endl;
+	cout << "l       : Toggle segmenting only the voxel volume's projection" << endl;
+	cout << "e       : Toggle sparse foreground evaluation (voxel pixels only)" << endl;
+	cout << "y       : Toggle YCrCb background subtraction (Value: luma, Saturation: chroma)" << endl;
+	cout << "a       : Cycle missing frame policy (repeat, skip, drop)" << endl;
+	cout << "w       : Toggle live mode (newest frame by the clock, drop stale frames)" << endl;
 	cout << "1,2,3,4 : Switch camera #" << endl << endl;
 	cout << "Zoom with the scrollwheel while on the 3D scene" << endl;
 	cout << "Rotate the 3D scene with left click+drag" << endl << endl;
+	cout << "Command line options:" << endl;
+	cout << "--benchmark-sparse [frames] : Compare the sparse foreground evaluation with the full-frame" << endl;
+	cout << "                              segmentation for several voxel steps (default 50 frames), then exit" << endl;
+	cout << "--threads N                 : Process at most N cameras at a time (default: all of them)" << endl;
+	cout << "--live-replay [seconds]     : Run the videos in live mode without windows (default 30 s), then" << endl;
+	cout << "                              exit (status 1 if too many frames dropped or the latency too high)" << endl << endl;
+}
+
+/**
+ * Run the videos in live mode for 'seconds' seconds: the frame loop of Glut::update (the same
+ * Scene3DRenderer::advanceLive and processStages), without windows and without rendering. Fails
+ * (EXIT_FAILURE) if more than MAX_DROP_RATIO of the frames were dropped or the average latency
+ * is over MAX_LATENCY_PERIODS frame periods.
+ */
+int VoxelReconstruction::replayLive(Scene3DRenderer &scene3d, Clustering &clustering, double seconds)
+{
+	LiveScheduler& live = scene3d.getLiveScheduler();
+	scene3d.setLive(true);
+
+	const chrono::steady_clock::time_point end = chrono::steady_clock::now()
+			+ chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+	while (chrono::steady_clock::now() < end)
+	{
+		scene3d.advanceLive();
+		if (scene3d.getCurrentFrame() == scene3d.getPreviousFrame())
+		{
+			// Ahead of the clock, wait for the next frame
+			this_thread::sleep_for(chrono::milliseconds(1));
+			continue;
+		}
+		if (!scene3d.restoreFrame())
+		{
+			scene3d.processStages(clustering);
+			live.endFrame();
+		}
+		scene3d.setPreviousFrame(scene3d.getCurrentFrame());
+	}
+
+	// The report (and leaving live mode) clears the statistics
+	const long frames = live.getFrames();
+	const double drop_ratio = live.getDropRatio();
+	const double latency = live.getLatency(), max_latency = MAX_LATENCY_PERIODS * live.getPeriod();
+	live.report(cout);
+
+	bool passed = frames > 0;
+	if (!passed) cout << "Live replay: no frames processed" << endl;
+	if (drop_ratio > MAX_DROP_RATIO)
+	{
+		cout << "Live replay: dropped " << 100 * drop_ratio << "% of the frames, more than " << 100 * MAX_DROP_RATIO
+				<< "%" << endl;
+		passed = false;
+	}
+	if (latency > max_latency)
+	{
+		cout << "Live replay: average latency " << 1000 * latency << " ms, more than " << 1000 * max_latency << " ms"
+				<< endl;
+		passed = false;
+	}
+	return passed ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 /**
  * - If the xml-file with camera intrinsics, extrinsics and distortion is missing,
  *   create it from the checkerboard video and the measured camera intrinsics
  * - After that initialize the scene rendering classes
- * - Run it!
+ * - Run it! (or the benchmark of the command line options, see showKeys)
  */
-void VoxelReconstruction::run(int argc, char** argv)
+int VoxelReconstruction::run(int argc, char** argv)
 {
+	int benchmark_frames = 0, threads = 0;
+	double replay_seconds = 0;
+	for (int a = 1; a < argc; ++a)
+	{
+		if (string(argv[a]) == "--benchmark-sparse")
+			benchmark_frames = a + 1 < argc && isdigit(argv[a + 1][0]) ? atoi(argv[++a]) : 50;
+		else if (string(argv[a]) == "--threads" && a + 1 < argc && isdigit(argv[a + 1][0]))
+			threads = atoi(argv[++a]);
+		else if (string(argv[a]) == "--live-replay")
+			replay_seconds = a + 1 < argc && isdigit(argv[a + 1][0]) ? atof(argv[++a]) : 30;
+	}
+	// Without windows (no display needed)
+	const bool headless = replay_seconds > 0;
+
+	//To decode the videos once into memory-mapped frame stores, which the cameras then read without decoding,
+	//  simply uncomment the next lines (FrameStore::BGR_HSV also stores the HSV frames)  --v
+	//for (int v = 0; v < _cam_views_amount; ++v)
+	//	FrameStore::transcode(_cam_views[v]->getDataPath() + General::VideoFile,
+	//			_cam_views[v]->getDataPath() + General::FrameStoreFile, FrameStore::BGR);
+
+	//To read the frames from capture processes through shared memory instead of from the videos
+	//  (eg. from the FrameRingProducer, replaying the videos), simply uncomment the next lines  --v
+	//for (int v = 0; v < _cam_views_amount; ++v)
+	//	_cam_views[v]->setFrameRing(SharedFrameRing::getName(v));
+
 	for (int v = 0; v < _cam_views_amount; ++v)
 	{
 		bool has_cam = Camera::detExtrinsics(_cam_views[v]->getDataPath(), General::CheckerboadVideo,
@@ -88,14 +189,25 @@ void VoxelReconstruction::run(int argc, char** argv)
 		assert(has_cam);
 	}
 
-	destroyAllWindows();
-	namedWindow(VIDEO_WINDOW, CV_WINDOW_KEEPRATIO);
+	if (!headless)
+	{
+		destroyAllWindows();
+		namedWindow(VIDEO_WINDOW, CV_WINDOW_KEEPRATIO);
+	}
 
-	Reconstructor reconstructor(_cam_views);
-	Scene3DRenderer scene3d(reconstructor, _cam_views);
+	//Change the second argument to 'true' to store the voxels in Morton (Z-order) instead of row-major order
+	Reconstructor reconstructor(_cam_views, false);
+	Scene3DRenderer scene3d(reconstructor, _cam_views, !headless);
+	if (threads > 0) scene3d.setThreads(threads);
 	//Make a clustering, containing color models to do the tracking
 	//Change the third argument to 'true' to show the initial labeling (instead of the final one)
- 	Clustering clustering(scene3d, 2, false);
+ 	Clustering clustering(scene3d, 2, false, !headless);
+	if (benchmark_frames > 0)
+	{
+		scene3d.benchmarkSparseForeground(benchmark_frames);
+		return EXIT_SUCCESS;
+	}
+	if (headless) return replayLive(scene3d, clustering, replay_seconds);
 	Glut glut(scene3d, clustering);
 	
 #ifdef __linux__
@@ -106,6 +218,7 @@ void VoxelReconstruction::run(int argc, char** argv)
 	
 
 #endif
+	return EXIT_SUCCESS;
 }
 
 } /* namespace nl_uu_science_gmt */
@@ -114,7 +227,5 @@ int main(int argc, char** argv)
 {
 	VoxelReconstruction::showKeys();
 	VoxelReconstruction vr("data" + string(PATH_SEP), 4);
-	vr.run(argc, argv);
-
-	return EXIT_SUCCESS;
+	return vr.run(argc, argv);
 }
\ No newline at end of file
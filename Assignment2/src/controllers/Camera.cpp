@@ -7,6 +7,18 @@
 
 #include "Camera.h"
 
+#include <chrono>
+#include <thread>
+
+#include "BackgroundModel.h"
+#include "BackgroundStatistics.h"
+#include "ColorSpace.h"
+#include "FramePrefetcher.h"
+#include "FrameStore.h"
+#include "SeekIndex.h"
+#include "SharedFrameRing.h"
+#include "VideoMetadata.h"
+
 using namespace std;
 using namespace cv;
 
@@ -25,10 +37,27 @@ Camera::Camera(const string &dp, const string &cp, const int id) :
 	_px = 0;
 	_py = 0;
 	_frames = 0;
+	_fps = 0;
+	_timestamp = 0;
+	_live = false;
+	_next_frame = 0;
+	_hsv_frame_valid = false;
+	_bg_model = NULL;
+	_foreground_packed = false;
+	_roi_margin = -1;
+	_seek_index = new SeekIndex();
+	_prefetcher = new FramePrefetcher();
+	_frame_store = new FrameStore();
+	_frame_ring = new SharedFrameRing();
 }
 
 Camera::~Camera()
 {
+	delete _prefetcher;  // stops the decode thread
+	delete _seek_index;
+	delete _frame_store;  // unmaps the frames
+	delete _frame_ring;
+	delete _bg_model;
 }
 
 /**
@@ -71,25 +100,89 @@ bool Camera::initialize()
 	assert(!bg_image.empty());
 
 	// Disect the background image in HSV-color space
-	Mat bg_hsv_im;
-	cvtColor(bg_image, bg_hsv_im, CV_BGR2HSV);
-	split(bg_hsv_im, _bg_hsv_channels);
+	ColorSpace::bgrToHsv(bg_image, _bg_hsv_image);
+
+	// With a background video, the background is the per-pixel mean over all its frames and
+	// the subtraction ignores differences within the pixel's noise (built once, then cached).
+	// YCrCb is linear in BGR, so its mean is the YCrCb of the BGR mean (it has no deviation).
+	_bg_hsv_deviation = Mat::zeros(_bg_hsv_image.size(), CV_8UC3);
+	if (General::fexists(_data_path + General::BackgroundVideoFile))
+	{
+		Mat mean, stddev, bgr_mean;
+		if (BackgroundStatistics::obtain(_data_path + General::BackgroundVideoFile,
+				_data_path + General::BackgroundStatsFile, mean, stddev, bgr_mean) && mean.size() == _bg_hsv_image.size())
+		{
+			_bg_hsv_image = mean;
+			stddev.convertTo(_bg_hsv_deviation, CV_8U, 2.5);  // like GaussianBackgroundModel
+			bg_image = bgr_mean;
+		}
+	}
+	split(_bg_hsv_image, _bg_hsv_channels);
+	ColorSpace::bgrToYCrCb(bg_image, _bg_ycrcb_image);
 
 	// Open the video for this camera
 	_video = VideoCapture(_data_path + General::VideoFile);
 	assert(_video.isOpened());
 
-	// Assess the image size
-	_plane_size.width = _video.get(CV_CAP_PROP_FRAME_WIDTH);
-	_plane_size.height = _video.get(CV_CAP_PROP_FRAME_HEIGHT);
+	// Read the image size, frame rate and amount of video frames from the container (cached)
+	VideoMetadata metadata;
+	if (metadata.obtain(_data_path + General::VideoFile, _data_path + General::VideoInfoFile))
+	{
+		_plane_size = metadata.size;
+		_frames = metadata.frames;
+		_fps = metadata.fps;
+	}
+	else
+	{
+		// Not an AVI file: assess the image size
+		_plane_size.width = _video.get(CV_CAP_PROP_FRAME_WIDTH);
+		_plane_size.height = _video.get(CV_CAP_PROP_FRAME_HEIGHT);
+		_fps = _video.get(CV_CAP_PROP_FPS);
+
+		// Get the amount of video frames
+		_video.set(CV_CAP_PROP_POS_AVI_RATIO, 1);  // Go to the end of the video; 1 = 100%
+		_frames = _video.get(CV_CAP_PROP_POS_FRAMES);
+		_video.set(CV_CAP_PROP_POS_AVI_RATIO, 0);  // Go back to the start
+	}
 	assert(_plane_size.area() > 0);
-
-	// Get the amount of video frames
-	_video.set(CV_CAP_PROP_POS_AVI_RATIO, 1);  // Go to the end of the video; 1 = 100%
-	_frames = _video.get(CV_CAP_PROP_POS_FRAMES);
 	assert(_frames > 1);
 
-	_video.set(CV_CAP_PROP_POS_AVI_RATIO, 0);  // Go back to the start
+	_next_frame = 0;
+
+	if (!_frame_ring_name.empty())
+	{
+		// Read the frames from a capture process (see SharedFrameRing), once it's there
+		cout << "Waiting for " << _frame_ring_name << "..." << flush;
+		for (int w = 0; w < RING_WAIT && !_frame_ring->open(_frame_ring_name); ++w)
+			this_thread::sleep_for(chrono::milliseconds(100));
+		if (_frame_ring->isOpen() && _frame_ring->getSize() != _plane_size) _frame_ring->close();
+		cout << (_frame_ring->isOpen() ? " connected" : " failed, reading the video instead") << endl;
+	}
+	else if (_frame_store->open(_data_path + General::FrameStoreFile, _data_path + General::VideoFile))
+	{
+		// Read the frames from the frame store if there's one for this video (see FrameStore::transcode)
+		if (_frame_store->getSize() == _plane_size)
+			_frames = _frame_store->getFramesAmount();
+		else
+			_frame_store->close();
+	}
+
+	if (!_frame_ring->isOpen() && !_frame_store->isOpen())
+	{
+		// Index the frames that can be seeked to exactly (once, cached next to the video)
+		if (!_seek_index->obtain(_data_path + General::VideoFile, _data_path + General::SeekIndexFile))
+			cout << "Unable to index: " << _data_path + General::VideoFile << endl;
+#ifdef DEBUG
+		// Random access must land on the requested frame
+		const bool accurate = _seek_index->isEmpty() || _seek_index->verify(8);
+		assert(accurate);
+#endif
+
+		// From here on the video is decoded ahead on its own thread, which then owns the capture
+		// (a VideoCapture copy shares it, so the camera drops its own)
+		_prefetcher->start(_video, PREFETCH_FRAMES, _seek_index);
+		_video = VideoCapture();
+	}
 
 	// Read the camera properties (XML)
 	FileStorage fs;
@@ -126,21 +219,213 @@ bool Camera::initialize()
 	return _initialized;
 }
 
+/**
+ * Only before initialize(), after that the prefetcher's decode thread owns the video
+ */
+const VideoCapture& Camera::getVideo() const
+{
+	assert(!_prefetcher->isRunning());
+	return _video;
+}
+
+void Camera::setVideo(const VideoCapture& video)
+{
+	assert(!_prefetcher->isRunning());
+	_video = video;
+}
+
+/**
+ * False when the frames come from a capture process (then they can only be read in order)
+ */
+bool Camera::isSeekable() const
+{
+	return !_frame_ring->isOpen();
+}
+
 /**
  * Set and return the next frame from the video
  */
 Mat& Camera::advanceVideoFrame()
 {
-	_video >> _frame;
+	if (_frame_ring->isOpen())
+	{
+		// A header over the shared memory (valid until the next read), numbered and timed by the producer
+		int64_t number = _next_frame;
+		_frame_ring->read(_frame, number, _timestamp, RING_TIMEOUT, _live);
+		_next_frame = (long) number;
+		_hsv_frame_valid = false;
+	}
+	else if (_frame_store->isOpen())
+	{
+		// Headers over the mapped frames, nothing is decoded or copied
+		_frame = _frame_store->frame(_next_frame);
+		_hsv_frame = _frame_store->hsvFrame(_next_frame);
+		_hsv_frame_valid = !_hsv_frame.empty();
+		_hsv_spans.clear();
+		_timestamp = _fps > 0 ? _next_frame / _fps : 0;
+	}
+	else
+	{
+		_prefetcher->read(_next_frame, _frame);
+		_hsv_frame_valid = false;
+		_timestamp = _fps > 0 ? _next_frame / _fps : 0;
+	}
+	++_next_frame;
+	_workspace.difference_valid = false;
 	return _frame;
 }
 
+/**
+ * Make the given (earlier decoded) frame the current frame, without touching the video
+ */
+void Camera::setFrame(const Mat &frame)
+{
+	if (_frame_store->isOpen() || _frame_ring->isOpen()) _frame = Mat();  // never copy into a mapping
+	frame.copyTo(_frame);
+	_hsv_frame_valid = false;
+	_workspace.difference_valid = false;
+}
+
+/**
+ * Return the current frame in HSV-color space, valid within the per row column spans 'spans'
+ * (NULL or empty: the whole frame). Every pixel is converted only once per frame, unless a
+ * stage already provided it through setHsvFrame.
+ */
+const Mat& Camera::getHsvFrame(const vector<Range>* spans)
+{
+	if (!_hsv_frame_valid)
+	{
+		ColorSpace::bgrToHsv(_frame, _workspace.hsv_frame);
+		_hsv_frame = _workspace.hsv_frame;
+		_hsv_frame_valid = true;
+		_hsv_spans.clear();
+		return _hsv_frame;
+	}
+	if (_hsv_spans.empty()) return _hsv_frame;
+
+	// Only part of the frame was converted (within a region of interest): convert what the
+	// requested spans add to it, the result is again one span per row
+	const bool whole = spans == NULL || spans->empty();
+	for (int y = 0; y < _hsv_frame.rows; ++y)
+	{
+		const Range wanted = whole ? Range(0, _hsv_frame.cols) : (*spans)[y];
+		Range &held = _hsv_spans[y];
+		if (wanted.empty()) continue;
+		if (held.empty())
+		{
+			ColorSpace::bgrToHsv(_frame, _hsv_frame, y, wanted);
+			held = wanted;
+			continue;
+		}
+		if (wanted.start < held.start) ColorSpace::bgrToHsv(_frame, _hsv_frame, y, Range(wanted.start, held.start));
+		if (wanted.end > held.end) ColorSpace::bgrToHsv(_frame, _hsv_frame, y, Range(held.end, wanted.end));
+		held = Range(min(held.start, wanted.start), max(held.end, wanted.end));
+	}
+	if (whole) _hsv_spans.clear();
+	return _hsv_frame;
+}
+
+/**
+ * Provide the HSV frame of the current frame (eg. as converted by the segmentation), valid within
+ * the per row column spans 'spans' only if given (the rest is converted when asked for)
+ */
+void Camera::setHsvFrame(const Mat &hsv_frame, const vector<Range>* spans)
+{
+	_hsv_frame = hsv_frame;
+	_hsv_frame_valid = true;
+	if (spans != NULL && !spans->empty())
+		_hsv_spans.assign(spans->begin(), spans->end());
+	else
+		_hsv_spans.clear();
+}
+
+/**
+ * Set the region of interest to the projection of the given (convex) volume:
+ * the pixels outside of it can never be seen by the reconstruction
+ */
+void Camera::setVolumeRoi(const vector<Point3f> &volume)
+{
+	vector<Point> projections, hull;
+	projectOnView(volume, projections);
+	convexHull(projections, hull);
+
+	Mat volume_mask = Mat::zeros(_plane_size, CV_8U);
+	fillConvexPoly(volume_mask, hull, Scalar::all(255));
+
+	// The projection is convex, so each row has a single span
+	_volume_spans.assign(_plane_size.height, Range(0, 0));
+	for (int y = 0; y < _plane_size.height; ++y)
+	{
+		const uchar* row = volume_mask.ptr<uchar>(y);
+		int start = 0, end = _plane_size.width;
+		while (start < end && row[start] == 0) ++start;
+		while (end > start && row[end - 1] == 0) --end;
+		_volume_spans[y] = Range(start, end);
+	}
+
+	_roi_margin = -1;
+}
+
+/**
+ * The per row column spans of the region of interest, grown by margin pixels in every direction
+ * (eg. so morphology within the volume projection is exact), empty if no volume was set
+ */
+const vector<Range>& Camera::getRoi(int margin)
+{
+	if (margin == _roi_margin || _volume_spans.empty()) return _roi;
+	_roi_margin = margin;
+
+	_roi.assign(_plane_size.height, Range(0, 0));
+	int x0 = _plane_size.width, x1 = 0, y0 = _plane_size.height, y1 = 0;
+	for (int y = 0; y < _plane_size.height; ++y)
+	{
+		int start = _plane_size.width, end = 0;
+		for (int yy = max(0, y - margin); yy <= min(_plane_size.height - 1, y + margin); ++yy)
+		{
+			if (_volume_spans[yy].empty()) continue;
+			start = min(start, _volume_spans[yy].start);
+			end = max(end, _volume_spans[yy].end);
+		}
+		if (start >= end) continue;
+
+		_roi[y] = Range(max(0, start - margin), min(_plane_size.width, end + margin));
+		x0 = min(x0, _roi[y].start);
+		x1 = max(x1, _roi[y].end);
+		y0 = min(y0, y);
+		y1 = max(y1, y + 1);
+	}
+	_roi_rect = x0 < x1 ? Rect(x0, y0, x1 - x0, y1 - y0) : Rect();
+
+	return _roi;
+}
+
+/**
+ * Remember where each workspace buffer lives and count the ones that moved since the last call,
+ * the first allocation of a buffer (eg. when a mode gets switched on) is not counted
+ */
+void Camera::Workspace::track()
+{
+	const cv::Mat* mats[] = { &hsv_frame, &subtraction, &morphology, &foreground, &integral, &background, &foreground_bgr,
+			&canvas, &difference };
+	const size_t amount = sizeof(mats) / sizeof(mats[0]);
+	if (buffers.size() != amount) buffers.assign(amount, (const uchar*) NULL);
+
+	for (size_t i = 0; i < amount; ++i)
+	{
+		if (mats[i]->data == buffers[i]) continue;
+		if (buffers[i] != NULL) ++reallocations;
+		buffers[i] = mats[i]->data;
+	}
+}
+
 /**
  * Set the video location to the given frame number
+ * (the prefetcher seeks once a frame other than the one it decoded ahead is read,
+ * via the nearest verified seek point of the seek index)
  */
 void Camera::setVideoFrame(int frame_number)
 {
-	_video.set(CV_CAP_PROP_POS_FRAMES, frame_number);
+	_next_frame = frame_number;
 }
 
 /**
@@ -487,4 +772,29 @@ Point Camera::projectOnView(const Point3f &coords)
 	return projectOnView(coords, _rotation_values, _translation_values, _camera_matrix, _distortion_coeffs);
 }
 
+/**
+ * Projects a batch of points from the scene space to the image coordinates
+ * in a single projectPoints call (much cheaper than projecting point by point)
+ */
+void Camera::projectOnView(const vector<Point3f> &coords, vector<Point> &points) const
+{
+	vector<Point2f> image_points;
+	projectOnView(coords, points, image_points);
+}
+
+/**
+ * Batch projection with a caller's buffer for the subpixel points, so a loop can reuse it
+ */
+void Camera::projectOnView(const vector<Point3f> &coords, vector<Point> &points, vector<Point2f> &image_points) const
+{
+	points.clear();
+	if (coords.empty()) return;
+
+	projectPoints(coords, _rotation_values, _translation_values, _camera_matrix, _distortion_coeffs, image_points);
+
+	points.resize(image_points.size());
+	for (size_t i = 0; i < image_points.size(); ++i)
+		points[i] = image_points[i];
+}
+
 } /* namespace nl_uu_science_gmt */
@@ -16,7 +16,7 @@ namespace nl_uu_science_gmt
 Glut* Glut::_glut;
 
 Glut::Glut(Scene3DRenderer &s3d, Clustering &clustering) :
-		_scene3d(s3d), _clustering(clustering)
+		_scene3d(s3d), _clustering(clustering), _redisplay(true), _key_presses(0)
 {
 	// static pointer to this class so we can get to it from the static GL events
 	_glut = this;
@@ -188,7 +188,9 @@ void Glut::mainLoopWindows()
 	while(!_glut->getScene3d().isQuit())
 	{
 		update(0);
-		display();
+		// Live, the scene is only drawn again after a frame that had time for it
+		if (!_glut->getScene3d().isLive() || _glut->getScene3d().isPaused() || _glut->_redisplay) display();
+		_glut->_redisplay = false;
 	}
 }
 #endif
@@ -240,6 +242,7 @@ void Glut::keyboard(unsigned char key, int x, int y)
 	int key_i = strtol(string(key, key).substr(0, 1).c_str(), &p_end, 10);
 
 	Scene3DRenderer& scene3d = _glut->getScene3d();
+	++_glut->_key_presses;
 	if (key_i == 0)
 	{
 		if (key == 'q' || key == 'Q')
@@ -306,6 +309,52 @@ void Glut::keyboard(unsigned char key, int x, int y)
 			reset();
 			arcball_reset();
 		}
+		else if (key == 'f' || key == 'F')
+		{
+			Reconstructor& reconstructor = scene3d.getReconstructor();
+			const int factor = reconstructor.getRefineFactor();
+			reconstructor.setRefineFactor(factor == 8 ? 1 : factor * 2);
+			cout << "Sub-voxel refinement: " << reconstructor.getRefineFactor() << "x" << endl;
+		}
+		else if (key == 'm' || key == 'M')
+		{
+			Reconstructor& reconstructor = scene3d.getReconstructor();
+			reconstructor.setFootprintMode(!reconstructor.isFootprintMode());
+			cout << "Voxel footprint test: " << (reconstructor.isFootprintMode() ? "on" : "off") << endl;
+		}
+		else if (key == 'k' || key == 'K')
+		{
+			scene3d.setPackedMasks(!scene3d.isPackedMasks());
+			cout << "Bit-packed foreground masks: " << (scene3d.isPackedMasks() ? "on" : "off") << endl;
+		}
+		else if (key == 'l' || key == 'L')
+		{
+			scene3d.setVolumeRoi(!scene3d.isVolumeRoi());
+			cout << "Segment the voxel volume's projection only: " << (scene3d.isVolumeRoi() ? "on" : "off") << endl;
+		}
+		else if (key == 'e' || key == 'E')
+		{
+			scene3d.setSparseForeground(!scene3d.isSparseForeground());
+			cout << "Sparse foreground evaluation: " << (scene3d.isSparseForeground() ? "on" : "off") << endl;
+		}
+		else if (key == 'y' || key == 'Y')
+		{
+			scene3d.setYCrCbSegmentation(!scene3d.isYCrCbSegmentation());
+			cout << "Background subtraction color space: " << (scene3d.isYCrCbSegmentation() ? "YCrCb" : "HSV") << endl;
+		}
+		else if (key == 'w' || key == 'W')
+		{
+			scene3d.setLive(!scene3d.isLive());
+			cout << "Live mode: " << (scene3d.isLive() ? "on" : "off") << endl;
+		}
+		else if (key == 'a' || key == 'A')
+		{
+			FrameBundleSource& source = scene3d.getBundleSource();
+			source.setPolicy((FrameBundleSource::MissingPolicy) ((source.getPolicy() + 1) % 3));
+			cout << "Missing frame policy: " << FrameBundleSource::getPolicyName(source.getPolicy()) << " (repeated: "
+					<< source.getRepeated() << ", skipped: " << source.getSkipped() << ", dropped: " << source.getDropped()
+					<< ")" << endl;
+		}
 	}
 	else if (key_i > 0 && key_i <= (int) scene3d.getCameras().size())
 	{
@@ -488,7 +537,13 @@ void Glut::reshape(int width, int height)
 void Glut::idle()
 {
 #ifdef __linux__
-	glutPostRedisplay();
+	// Live, the scene is only drawn again after a frame that had time for it
+	Scene3DRenderer& scene3d = _glut->getScene3d();
+	if (!scene3d.isLive() || scene3d.isPaused() || _glut->_redisplay)
+	{
+		_glut->_redisplay = false;
+		glutPostRedisplay();
+	}
 #endif
 }
 
@@ -538,7 +593,9 @@ void Glut::display()
  */
 void Glut::update(int v)
 {
-	char key = waitKey(10);
+	// Live, the frames are paced by the clock instead
+	const int interval = _glut->getScene3d().isLive() ? 1 : 10;
+	char key = waitKey(interval);
 	keyboard(key, 0, 0);  // call glut key handler :)
 	//somewhere in here do the clustering logic --v
 	Clustering& clustering = _glut->getClustering();
@@ -563,25 +620,61 @@ void Glut::update(int v)
 		for (size_t c = 0; c < scene3d.getCameras().size(); ++c)
 			scene3d.getCameras()[c]->setVideoFrame(scene3d.getCurrentFrame());
 	}
-	if (!scene3d.isPaused())
+	LiveScheduler& live = scene3d.getLiveScheduler();
+	const bool live_frame = scene3d.isLive() && !scene3d.isPaused();
+	if (live_frame)
+	{
+		// Live: take the newest frame by the clock, the frames the processing didn't get to are dropped
+		scene3d.advanceLive();
+	}
+	else if (!scene3d.isPaused())
 	{
 		// If not paused move to the next frame
 		scene3d.setCurrentFrame(scene3d.getCurrentFrame() + 1);
 	}
-	if (scene3d.getCurrentFrame() != scene3d.getPreviousFrame())
+	else
+	{
+		live.stop();
+	}
+	bool render = true, live_processed = false;
+#ifdef DEBUG
+	bool check_allocations = false;
+	size_t reallocations = 0;
+#endif
+	if (scene3d.getCurrentFrame() != scene3d.getPreviousFrame() && scene3d.restoreFrame())
+	{
+		// The frame was processed before with the same parameters (eg. when scrubbing back and forth)
+		scene3d.setPreviousFrame(scene3d.getCurrentFrame());
+	}
+	else if (scene3d.getCurrentFrame() != scene3d.getPreviousFrame())
 	{
 		// If the current frame is different from the last iteration update stuff
-		scene3d.processFrame();
-		scene3d.getReconstructor().update();
-		// Added clustering step, to set the color of the voxels
-		clustering.processFrame();
+		// (unless not all cameras had the frame and the bundle was dropped)
+		live_processed = live_frame;
+#ifdef DEBUG
+		// The whole frame gets checked for allocations (from the segmentation on, see below), but not
+		// the first frame after a key press: a mode allocates its buffers on its first frame
+		static int previous_key_presses = -1;
+		check_allocations = _glut->_key_presses == previous_key_presses
+				&& scene3d.getReconstructor().getRefineFactor() == 1;
+		previous_key_presses = _glut->_key_presses;
+		for (size_t c = 0; c < scene3d.getCameras().size(); ++c)
+		{
+			Camera::Workspace &camera_workspace = scene3d.getCameras()[c]->getWorkspace();
+			camera_workspace.track();
+			reallocations += camera_workspace.reallocations;
+		}
+#endif
+		// Segmentation, carving and clustering (live: timed, see Scene3DRenderer::processStages)
+		render = scene3d.processStages(clustering);
 		scene3d.setPreviousFrame(scene3d.getCurrentFrame());
 	}
 	else if (scene3d.getHThreshold() != scene3d.getPHThreshold() || scene3d.getSThreshold() != scene3d.getPSThreshold()
 						|| scene3d.getVThreshold() != scene3d.getPVThreshold())
 	{
-		// Update the scene if one of the HSV sliders was moved (when the video is paused)
-		scene3d.processFrame();
+		// Update the scene if one of the HSV sliders was moved (when the video is paused),
+		// the frames didn't change so only the thresholding onwards runs again
+		scene3d.processThresholds();
 		scene3d.getReconstructor().update();
 
 		scene3d.setPHThreshold(scene3d.getHThreshold());
@@ -596,37 +689,63 @@ void Glut::update(int v)
 	}
 
 	// Get the image and the foreground image (of set camera)
-	Mat canvas, foreground;
-	if (scene3d.getCurrentCamera() != -1)
+	Camera* camera = scene3d.getCurrentCamera() != -1 ?
+			scene3d.getCameras()[scene3d.getCurrentCamera()] : scene3d.getCameras()[scene3d.getPreviousCamera()];
+	Camera::Workspace &workspace = camera->getWorkspace();
+	Mat canvas = camera->getFrame();
+	Mat foreground = camera->getForegroundImage();
+	if (render && camera->isForegroundPacked())
 	{
-		canvas = scene3d.getCameras()[scene3d.getCurrentCamera()]->getFrame();
-		foreground = scene3d.getCameras()[scene3d.getCurrentCamera()]->getForegroundImage();
-	}
-	else
-	{
-		canvas = scene3d.getCameras()[scene3d.getPreviousCamera()]->getFrame();
-		foreground = scene3d.getCameras()[scene3d.getPreviousCamera()]->getForegroundImage();
+		// Only the shown camera's packed mask gets expanded, for display
+		camera->getPackedForeground().unpack(workspace.foreground);
+		foreground = workspace.foreground;
 	}
 
-	// Concatenate the video frame with the foreground image (of set camera)
-	if (!canvas.empty() && !foreground.empty())
+	// Concatenate the video frame with the foreground image (of set camera),
+	// unless live and out of time (then the last one stays)
+	if (render && !canvas.empty() && !foreground.empty())
 	{
-		Mat fg_im_3c;
-		cvtColor(foreground, fg_im_3c, CV_GRAY2BGR);
-		hconcat(canvas, fg_im_3c, canvas);
-		imshow(VIDEO_WINDOW, canvas);
+		// Into the camera's display buffers, so they're reused every frame
+		cvtColor(foreground, workspace.foreground_bgr, CV_GRAY2BGR);
+		hconcat(canvas, workspace.foreground_bgr, workspace.canvas);
+		imshow(VIDEO_WINDOW, workspace.canvas);
 	}
-	else if (!canvas.empty())
+	else if (render && !canvas.empty())
 	{
 		imshow(VIDEO_WINDOW, canvas);
 	}
 
 	// Update the frame slider position
-	setTrackbarPos("Frame", VIDEO_WINDOW, scene3d.getCurrentFrame());
+	if (render) setTrackbarPos("Frame", VIDEO_WINDOW, scene3d.getCurrentFrame());
+	_glut->_redisplay = _glut->_redisplay || render;
+
+	if (live_processed)
+	{
+		if (render) live.endStage(LiveScheduler::RENDERING);
+		live.endFrame();
+	}
+	if (live.isReportDue()) live.report(cout);
+
+#ifdef DEBUG
+	// Once allocated, the frame loop reuses its buffers: the cameras' workspace buffers (cv::Mat storage,
+	// which operator new doesn't see) didn't move, display included, and the processing didn't allocate
+	// through operator new (the frame cache does). Only the refinement still allocates (its sub-voxel
+	// pool and visible voxels grow with the boundary).
+	if (check_allocations)
+	{
+		for (size_t c = 0; c < scene3d.getCameras().size(); ++c)
+		{
+			Camera::Workspace &camera_workspace = scene3d.getCameras()[c]->getWorkspace();
+			camera_workspace.track();
+			reallocations -= camera_workspace.reallocations;
+		}
+		assert(reallocations == 0 && scene3d.getFrameAllocations() == 0);
+	}
+#endif
 
 #ifdef __linux__
 	glutSwapBuffers();
-	glutTimerFunc(10, update, 0);
+	glutTimerFunc(interval, update, 0);
 #endif
 }
 
@@ -814,22 +933,32 @@ void Glut::drawVoxels()
 
 	// apply default translation
 	glTranslatef(0, 0, 0);
-	glPointSize(2.0f);
-	glBegin(GL_POINTS);
 
+	const int step = _glut->getScene3d().getReconstructor().getStep();
 	vector<Reconstructor::Voxel*> voxels = _glut->getScene3d().getReconstructor().getVisibleVoxels();
-	for (size_t v = 0; v < voxels.size(); v++)
+
+	// Coarse voxels first, then the (smaller) refined sub-voxels
+	for (int pass = 0; pass < 2; ++pass)
 	{
-		//Use the voxel's color attribute, set by the clustering
-		glColor4f(
-			voxels[v]->color[0],
-			voxels[v]->color[1],
-			voxels[v]->color[2],
-			0.5f);
-		glVertex3f((GLfloat) voxels[v]->x, (GLfloat) voxels[v]->y, (GLfloat) voxels[v]->z);	
+		glPointSize(pass == 0 ? 2.0f : 1.0f);
+		glBegin(GL_POINTS);
+
+		for (size_t v = 0; v < voxels.size(); v++)
+		{
+			if ((voxels[v]->size == step) != (pass == 0)) continue;
+
+			//Use the voxel's color attribute, set by the clustering
+			glColor4f(
+				voxels[v]->color[0],
+				voxels[v]->color[1],
+				voxels[v]->color[2],
+				0.5f);
+			glVertex3f((GLfloat) voxels[v]->x, (GLfloat) voxels[v]->y, (GLfloat) voxels[v]->z);
+		}
+
+		glEnd();
 	}
 
-	glEnd();
 	glPopMatrix();
 }
 
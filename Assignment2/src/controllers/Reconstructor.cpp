@@ -16,8 +16,8 @@ namespace nl_uu_science_gmt
 /**
  * Voxel reconstruction class
  */
-Reconstructor::Reconstructor(const vector<Camera*> &cs) :
-		_cameras(cs)
+Reconstructor::Reconstructor(const vector<Camera*> &cs, bool morton_order) :
+		_cameras(cs), _morton_order(morton_order)
 {
 	for (size_t c = 0; c < _cameras.size(); ++c)
 	{
@@ -29,11 +29,94 @@ Reconstructor::Reconstructor(const vector<Camera*> &cs) :
 
 	_step = 32;
 	_size = 512;
+	_refine_factor = 1;
+	_footprint_mode = false;
+	_footprint_fraction = 0.5f;
+	_packed = false;
+	_sub_voxels_used = 0;
 	const size_t h_edge = _size * 4;
 	const size_t edge = 2 * h_edge;
-	_voxels_amount = (edge / _step) * (edge / _step) * (h_edge / _step);
+	_x_voxels = edge / _step;
+	_y_voxels = edge / _step;
+	_z_voxels = h_edge / _step;
+	_voxels_amount = _x_voxels * _y_voxels * _z_voxels;
+
+	if (_morton_order)
+	{
+		// Bits needed per axis
+		int x_bits = 0, y_bits = 0, z_bits = 0;
+		while ((1 << x_bits) < _x_voxels) ++x_bits;
+		while ((1 << y_bits) < _y_voxels) ++y_bits;
+		while ((1 << z_bits) < _z_voxels) ++z_bits;
+
+		// Interleave the bits x-y-z from the least significant bit up, while an axis still has bits left
+		vector<int> x_positions, y_positions, z_positions;
+		int position = 0;
+		for (int b = 0; b < max(x_bits, max(y_bits, z_bits)); ++b)
+		{
+			if (b < x_bits) x_positions.push_back(position++);
+			if (b < y_bits) y_positions.push_back(position++);
+			if (b < z_bits) z_positions.push_back(position++);
+		}
+
+		spreadBits(_morton_x, _x_voxels, x_positions);
+		spreadBits(_morton_y, _y_voxels, y_positions);
+		spreadBits(_morton_z, _z_voxels, z_positions);
+
+		// Exact for power of two dimensions, otherwise some index slots remain empty
+		_voxels_amount = (size_t) 1 << position;
+	}
+
+	// Let the compiler see the camera count of fixed rigs, larger rigs use the generic kernel
+	switch (_cameras.size())
+	{
+	case 1:
+		_carve = &Reconstructor::carve<1, false>;
+		_carve_packed = &Reconstructor::carve<1, true>;
+		break;
+	case 2:
+		_carve = &Reconstructor::carve<2, false>;
+		_carve_packed = &Reconstructor::carve<2, true>;
+		break;
+	case 3:
+		_carve = &Reconstructor::carve<3, false>;
+		_carve_packed = &Reconstructor::carve<3, true>;
+		break;
+	case 4:
+		_carve = &Reconstructor::carve<4, false>;
+		_carve_packed = &Reconstructor::carve<4, true>;
+		break;
+	case 5:
+		_carve = &Reconstructor::carve<5, false>;
+		_carve_packed = &Reconstructor::carve<5, true>;
+		break;
+	case 6:
+		_carve = &Reconstructor::carve<6, false>;
+		_carve_packed = &Reconstructor::carve<6, true>;
+		break;
+	case 7:
+		_carve = &Reconstructor::carve<7, false>;
+		_carve_packed = &Reconstructor::carve<7, true>;
+		break;
+	case 8:
+		_carve = &Reconstructor::carve<8, false>;
+		_carve_packed = &Reconstructor::carve<8, true>;
+		break;
+	default:
+		_carve = &Reconstructor::carveGeneric;
+		_carve_packed = &Reconstructor::carveGeneric;
+		break;
+	}
 
 	initialize();
+	findReferencedPixels();
+
+	// Size the per-frame containers up front, so update() doesn't allocate
+	_masks.resize(_cameras.size());
+	_packed_masks.resize(_cameras.size());
+	_occupancy.reserve(_voxels_amount);
+	_visible_voxels.reserve(_voxels_amount);
+	_coarse_voxels.reserve(_voxels_amount);
 }
 
 /**
@@ -45,6 +128,8 @@ Reconstructor::~Reconstructor()
 		delete _corners.at(c);
 	for (size_t v = 0; v < _voxels.size(); ++v)
 		delete _voxels.at(v);
+	for (size_t v = 0; v < _sub_voxels.size(); ++v)
+		delete _sub_voxels.at(v);
 }
 
 /**
@@ -78,8 +163,9 @@ void Reconstructor::initialize()
 
 	cout << "Initializing voxels";
 
-	// Acquire some memory for efficiency
-	_voxels.resize(_voxels_amount);
+	// Acquire some memory for efficiency (unused Morton index slots keep a NULL voxel and invalid projections)
+	_voxels.assign(_voxels_amount, NULL);
+	_projection_offsets.assign(_voxels_amount * _cameras.size(), -1);
 
 #ifdef PARALLEL_PROCESS
 #pragma omp parallel for //schedule(static, 1)
@@ -88,47 +174,155 @@ void Reconstructor::initialize()
 	{
 		cout << "." << flush;
 
+		// Gather the voxel positions of this z-slice, so they can be projected in one batch per camera
+		vector<Point3f> slice;
+		slice.reserve(_x_voxels * _y_voxels);
 		for (int y = yL; y < yR; y += _step)
-		{
 			for (int x = xL; x < xR; x += _step)
+				slice.push_back(Point3f((float) x, (float) y, (float) z));
+
+		// The 8 corners of each voxel cube [x, x + step), for the footprint of the voxel on each camera
+		vector<Point3f> slice_corners;
+		slice_corners.reserve(8 * slice.size());
+		const float step = (float) _step;
+		for (size_t s = 0; s < slice.size(); ++s)
+			for (int k = 0; k < 8; ++k)
+				slice_corners.push_back(Point3f(slice[s].x + (k & 1 ? step : 0), slice[s].y + (k & 2 ? step : 0),
+						slice[s].z + (k & 4 ? step : 0)));
+
+		vector<vector<Point> > projections(_cameras.size());
+		vector<vector<Point> > corner_projections(_cameras.size());
+		for (size_t c = 0; c < _cameras.size(); ++c)
+		{
+			_cameras[c]->projectOnView(slice, projections[c]);
+			_cameras[c]->projectOnView(slice_corners, corner_projections[c]);
+		}
+
+		const Rect image_rect(0, 0, _plane_size.width, _plane_size.height);
+		const int zp = ((z - zL) / _step);
+		for (size_t s = 0; s < slice.size(); ++s)
+		{
+			Voxel* voxel = new Voxel;
+			voxel->x = (int) slice[s].x;
+			voxel->y = (int) slice[s].y;
+			voxel->z = z;
+			voxel->size = _step;
+			voxel->cluster = -1;
+			voxel->camera_projection = vector<Point>(_cameras.size());
+			voxel->valid_camera_projection = vector<int>(_cameras.size(), 0);
+			voxel->camera_footprint = vector<Rect>(_cameras.size());
+			voxel->occluded_from_camera = vector<bool>(_cameras.size(), false);
+
+			const int yp = (int) s / _x_voxels;
+			const int xp = (int) s % _x_voxels;
+			const int p = voxelIndex(xp, yp, zp);  // The voxel's index
+
+			for (size_t c = 0; c < _cameras.size(); ++c)
 			{
-				Voxel* voxel = new Voxel;
-				voxel->x = x;
-				voxel->y = y;
-				voxel->z = z;
-				voxel->cluster = -1;
-				voxel->camera_projection = vector<Point>(_cameras.size());
-				voxel->valid_camera_projection = vector<int>(_cameras.size(), 0);
-				voxel->occluded_from_camera = vector<bool>(_cameras.size(), false);
-
-				const int zp = ((z - zL) / _step);
-				const int yp = ((y - yL) / _step);
-				const int xp = ((x - xL) / _step);
-				const int plane_y = (yR - yL) / _step;
-				const int plane_x = (xR - xL) / _step;
-				const int plane = plane_y * plane_x;
-				const int p = zp * plane + yp * plane_x + xp;  // The voxel's index
+				const Point point = projections[c][s];
 
-				for (size_t c = 0; c < _cameras.size(); ++c)
-				{
-					Point point = _cameras[c]->projectOnView(Point3f((float) x, (float) y, (float) z));
+				// Save the pixel coordinates 'point' of the voxel projections on camera 'c'
+				voxel->camera_projection[(int) c] = point;
 
-					// Save the pixel coordinates 'point' of the voxel projections on camera 'c'
-					voxel->camera_projection[(int) c] = point;
+				if (point.x >= 0 && point.x < _plane_size.width && point.y >= 0 && point.y < _plane_size.height)
+					voxel->valid_camera_projection[(int) c] = 1;
 
-					if (point.x >= 0 && point.x < _plane_size.width && point.y >= 0 && point.y < _plane_size.height)
-						voxel->valid_camera_projection[(int) c] = 1;
-				}
+				// Save the offset of 'point' in the (continuous) foreground image for the carving kernels
+				_projection_offsets[p * _cameras.size() + c] =
+						voxel->valid_camera_projection[(int) c] ? point.y * _plane_size.width + point.x : -1;
 
-				//'p' is not critical as it's unique
-				_voxels[p] = voxel;
+				// Save the bounding rectangle of the projected voxel cube on camera 'c'
+				const vector<Point> corners(corner_projections[c].begin() + 8 * s, corner_projections[c].begin() + 8 * (s + 1));
+				voxel->camera_footprint[(int) c] = boundingRect(corners) & image_rect;
 			}
+
+			//'p' is not critical as it's unique
+			_voxels[p] = voxel;
 		}
 	}
 
 	cout << "done!" << endl;
 }
 
+/**
+ * Collect per camera the distinct pixels the voxel projections fall on, for the sparse
+ * foreground evaluation (see Foreground::subtractHSVSparse)
+ */
+void Reconstructor::findReferencedPixels()
+{
+	const size_t cameras = _cameras.size();
+	_referenced_pixels.assign(cameras, vector<int>());
+
+	vector<uchar> referenced(_plane_size.area());
+	for (size_t c = 0; c < cameras; ++c)
+	{
+		fill(referenced.begin(), referenced.end(), 0);
+		for (size_t p = 0; p < _voxels_amount; ++p)
+		{
+			const int offset = _projection_offsets[p * cameras + c];
+			if (offset >= 0) referenced[offset] = 1;
+		}
+
+		for (int i = 0; i < (int) referenced.size(); ++i)
+			if (referenced[i]) _referenced_pixels[c].push_back(i);
+	}
+}
+
+/**
+ * The same as findReferencedPixels() for a voxel grid of the given half edge 'size' * 4
+ * and 'step', without building the voxels (eg. to compare grid resolutions)
+ */
+void Reconstructor::findReferencedPixels(const vector<Camera*> &cameras, int size, int step,
+		vector<vector<int> > &referenced_pixels)
+{
+	const int h_edge = size * 4;
+	referenced_pixels.assign(cameras.size(), vector<int>());
+
+	for (size_t c = 0; c < cameras.size(); ++c)
+	{
+		const Size plane_size = cameras[c]->getSize();
+		vector<uchar> referenced(plane_size.area(), 0);
+
+		// One z-slice at a time, like initialize()
+		vector<Point3f> slice;
+		vector<Point> projections;
+		for (int z = 0; z < h_edge; z += step)
+		{
+			slice.clear();
+			for (int y = -h_edge; y < h_edge; y += step)
+				for (int x = -h_edge; x < h_edge; x += step)
+					slice.push_back(Point3f((float) x, (float) y, (float) z));
+
+			cameras[c]->projectOnView(slice, projections);
+			for (size_t s = 0; s < projections.size(); ++s)
+			{
+				const Point &point = projections[s];
+				if (point.x >= 0 && point.x < plane_size.width && point.y >= 0 && point.y < plane_size.height)
+					referenced[point.y * plane_size.width + point.x] = 1;
+			}
+		}
+
+		for (int i = 0; i < (int) referenced.size(); ++i)
+			if (referenced[i]) referenced_pixels[c].push_back(i);
+	}
+}
+
+/**
+ * Build the table of Morton code bits for each grid position on an axis,
+ * bit 'b' of the position moves to bit positions[b] of the code
+ */
+void Reconstructor::spreadBits(vector<int> &table, int dimension, const vector<int> &positions)
+{
+	table.resize(dimension);
+	for (int i = 0; i < dimension; ++i)
+	{
+		int code = 0;
+		for (size_t b = 0; b < positions.size(); ++b)
+			if (i & (1 << b)) code |= 1 << positions[b];
+		table[i] = code;
+	}
+}
+
 /**
  * Count the amount of camera's each voxel in the space appears on,
  * if that amount equals the amount of cameras, add that voxel to the
@@ -139,33 +333,343 @@ void Reconstructor::initialize()
 void Reconstructor::update()
 {
 	_visible_voxels.clear();
+	_occupancy.assign(_voxels_amount, 0);
+
+	// Carve from the bit-packed masks when all cameras produced them
+	_packed = true;
+	for (size_t c = 0; c < _cameras.size(); ++c)
+		_packed = _packed && _cameras[c]->isForegroundPacked();
+	if (_packed && _projection_bits.empty()) buildProjectionBits();
+
+	// The integral images allow O(1) foreground counts over any footprint rectangle,
+	// they're kept on the cameras so other stages can share them
+	// (packed masks get per row popcount prefixes instead)
+	if (_footprint_mode)
+	{
+		for (size_t c = 0; c < _cameras.size(); ++c)
+		{
+			if (_packed)
+			{
+				_cameras[c]->getWorkspace().packed_foreground.summarize();
+				continue;
+			}
+			Mat &foreground_integral = _cameras[c]->getWorkspace().integral;
+			integral(_cameras[c]->getForegroundImage(), foreground_integral, CV_32S);
+			_cameras[c]->setForegroundIntegral(foreground_integral);
+		}
+
+		carveGeneric();
+	}
+	else
+	{
+		(this->*(_packed ? _carve_packed : _carve))();
+	}
+
+	// Collect the visible voxels in index order
+	for (size_t v = 0; v < _voxels_amount; ++v)
+		if (_occupancy[v]) _visible_voxels.push_back(_voxels[v]);
+
+	if (_refine_factor > 1) refine();
+}
+
+/**
+ * Carving kernel specialized on the amount of cameras
+ *
+ * The camera loop has a compile-time trip count (so it's fully unrolled), the
+ * mask base pointers are hoisted out of the voxel loop and the projections are
+ * read from the flat offset LUT instead of the Voxel objects. The PACKED kernel
+ * tests one bit of the 1-bit masks, through the bit offset LUT.
+ */
+template<int CAMERAS, bool PACKED>
+void Reconstructor::carve()
+{
+	assert((int ) _cameras.size() == CAMERAS);
+
+	const uchar* masks[CAMERAS];
+	const uint64_t* packed_masks[CAMERAS];
+	for (int c = 0; c < CAMERAS; ++c)
+	{
+		if (PACKED)
+		{
+			packed_masks[c] = _cameras[c]->getPackedForeground().getWords();
+			continue;
+		}
+		const Mat &foreground = _cameras[c]->getForegroundImage();
+		assert(foreground.isContinuous() && foreground.type() == CV_8U);
+		masks[c] = foreground.ptr<uchar>();
+	}
+
+	const int* offsets = PACKED ? &_projection_bits[0] : &_projection_offsets[0];
+	uchar* occupancy = &_occupancy[0];
+	const int voxels_amount = (int) _voxels_amount;
 
 #ifdef PARALLEL_PROCESS
 #pragma omp parallel for //schedule(static, 1)
 #endif
-	for (size_t v = 0; v < _voxels_amount; ++v)
+	for (int v = 0; v < voxels_amount; ++v)
+	{
+		const int* voxel_offsets = offsets + v * CAMERAS;
+
+		// The voxel is present if there's a white pixel at its projection on all cameras
+		bool visible = true;
+		for (int c = 0; c < CAMERAS; ++c)
+		{
+			const int offset = voxel_offsets[c];
+			if (PACKED)
+				visible = visible && offset >= 0 && ((packed_masks[c][offset >> 6] >> (offset & 63)) & 1);
+			else
+				visible = visible && offset >= 0 && masks[c][offset] == 255;
+		}
+
+		occupancy[v] = visible;
+	}
+}
+
+/**
+ * Carving kernel for any amount of cameras, also handles the footprint test
+ */
+void Reconstructor::carveGeneric()
+{
+	const int cameras = (int) _cameras.size();
+
+	const uchar** masks = &_masks[0];
+	const uint64_t** packed_masks = &_packed_masks[0];
+	for (int c = 0; c < cameras; ++c)
+	{
+		if (_packed)
+		{
+			packed_masks[c] = _cameras[c]->getPackedForeground().getWords();
+			continue;
+		}
+		const Mat &foreground = _cameras[c]->getForegroundImage();
+		assert(foreground.isContinuous() && foreground.type() == CV_8U);
+		masks[c] = foreground.ptr<uchar>();
+	}
+	const int* offsets = _packed ? &_projection_bits[0] : &_projection_offsets[0];
+
+	const int voxels_amount = (int) _voxels_amount;
+
+#ifdef PARALLEL_PROCESS
+#pragma omp parallel for //schedule(static, 1)
+#endif
+	for (int v = 0; v < voxels_amount; ++v)
 	{
 		int camera_counter = 0;
-		Voxel* voxel = _voxels[v];
+		const Voxel* voxel = _voxels[v];
+		const int* voxel_offsets = &offsets[v * cameras];
+		if (voxel == NULL) continue;  // unused Morton index slot
 
-		for (size_t c = 0; c < _cameras.size(); ++c)
+		for (int c = 0; c < cameras; ++c)
 		{
-			if (voxel->valid_camera_projection[c])
+			if (_footprint_mode)
+			{
+				//If enough of the voxel's footprint on the foreground image is white, add the camera
+				if (inFootprint(voxel, c)) ++camera_counter;
+			}
+			else if (voxel_offsets[c] >= 0)
 			{
-				const Point point = voxel->camera_projection[c];
-
 				//If there's a white pixel on the foreground image at the projection point, add the camera
-				if (_cameras[c]->getForegroundImage().at<uchar>(point) == 255) ++camera_counter;
+				const int offset = voxel_offsets[c];
+				if (_packed ? (packed_masks[c][offset >> 6] >> (offset & 63)) & 1 : masks[c][offset] == 255)
+					++camera_counter;
 			}
 		}
 
 		// If the voxel is present on all cameras
-		if (camera_counter == _cameras.size())
+		_occupancy[v] = camera_counter == cameras;
+	}
+}
+
+/**
+ * Convert the pixel offset LUT to bit offsets in the packed masks, whose rows are padded to whole words
+ */
+void Reconstructor::buildProjectionBits()
+{
+	const int row_bits = ((_plane_size.width + PackedMask::WORD_BITS - 1) / PackedMask::WORD_BITS) * PackedMask::WORD_BITS;
+
+	_projection_bits.resize(_projection_offsets.size());
+	for (size_t i = 0; i < _projection_offsets.size(); ++i)
+	{
+		const int offset = _projection_offsets[i];
+		_projection_bits[i] = offset < 0 ? -1 : (offset / _plane_size.width) * row_bits + offset % _plane_size.width;
+	}
+}
+
+/**
+ * Check if at least _footprint_fraction of the voxel's footprint on camera 'c' is foreground,
+ * in O(1) using the integral image of the camera's foreground image
+ * (or in O(footprint height) popcounts for packed masks)
+ */
+bool Reconstructor::inFootprint(const Voxel* voxel, size_t c) const
+{
+	const Rect &footprint = voxel->camera_footprint[c];
+	if (footprint.area() == 0) return false;
+
+	if (_packed) return _cameras[c]->getPackedForeground().count(footprint) >= _footprint_fraction * footprint.area();
+
+	const Mat &integral_image = _cameras[c]->getForegroundIntegral();
+	const int sum = integral_image.at<int>(footprint.y + footprint.height, footprint.x + footprint.width)
+			- integral_image.at<int>(footprint.y, footprint.x + footprint.width)
+			- integral_image.at<int>(footprint.y + footprint.height, footprint.x)
+			+ integral_image.at<int>(footprint.y, footprint.x);
+
+	return sum >= _footprint_fraction * 255 * footprint.area();
+}
+
+/**
+ * Check if the voxel at grid position (xp, yp, zp) lies on the silhouette boundary,
+ * ie.: its occupancy differs from at least one of its 6 neighbors (outside the grid counts as empty)
+ */
+bool Reconstructor::isBoundary(int xp, int yp, int zp) const
+{
+	static const int offsets[6][3] = { { -1, 0, 0 }, { 1, 0, 0 }, { 0, -1, 0 }, { 0, 1, 0 }, { 0, 0, -1 }, { 0, 0, 1 } };
+
+	const uchar occupied = _occupancy[voxelIndex(xp, yp, zp)];
+	for (int n = 0; n < 6; ++n)
+	{
+		const int nx = xp + offsets[n][0];
+		const int ny = yp + offsets[n][1];
+		const int nz = zp + offsets[n][2];
+
+		uchar neighbor = 0;
+		if (nx >= 0 && nx < _x_voxels && ny >= 0 && ny < _y_voxels && nz >= 0 && nz < _z_voxels)
+			neighbor = _occupancy[voxelIndex(nx, ny, nz)];
+
+		if (neighbor != occupied) return true;
+	}
+
+	return false;
+}
+
+/**
+ * Hand out a sub-voxel from the pool, growing the pool when it's exhausted
+ */
+Reconstructor::Voxel* Reconstructor::acquireSubVoxel()
+{
+	if (_sub_voxels_used == _sub_voxels.size())
+	{
+		Voxel* voxel = new Voxel;
+		voxel->camera_projection = vector<Point>(_cameras.size());
+		voxel->valid_camera_projection = vector<int>(_cameras.size(), 0);
+		voxel->camera_footprint = vector<Rect>(_cameras.size());
+		voxel->occluded_from_camera = vector<bool>(_cameras.size(), false);
+		_sub_voxels.push_back(voxel);
+	}
+
+	return _sub_voxels[_sub_voxels_used++];
+}
+
+/**
+ * Adaptive sub-voxel refinement
+ *
+ * Voxels whose neighborhood is only partly occupied after the coarse pass are
+ * re-carved at _refine_factor times finer steps. The sub-voxels are projected on
+ * demand (one batch per voxel per camera) and tested at their center pixel only.
+ * Interior voxels stay coarse, so the visible voxels become a mixed-resolution
+ * list (see Voxel::size).
+ */
+void Reconstructor::refine()
+{
+	_sub_voxels_used = 0;
+
+	const int h_edge = _size * 4;
+
+	// Find all (occupied and empty) voxels on the boundary of the coarse reconstruction
+	vector<int> boundary;
+#ifdef PARALLEL_PROCESS
+#pragma omp parallel for //schedule(static, 1)
+#endif
+	for (int zp = 0; zp < _z_voxels; ++zp)
+	{
+		vector<int> slice_boundary;
+		for (int yp = 0; yp < _y_voxels; ++yp)
+			for (int xp = 0; xp < _x_voxels; ++xp)
+				if (isBoundary(xp, yp, zp)) slice_boundary.push_back(voxelIndex(xp, yp, zp));
+
+#ifdef PARALLEL_PROCESS
+#pragma omp critical //insert is critical
+#endif
+		boundary.insert(boundary.end(), slice_boundary.begin(), slice_boundary.end());
+	}
+
+	// Keep only the interior voxels at the coarse resolution
+	// (swapping with the member keeps the reserved capacity of both lists)
+	vector<Voxel*> &coarse_voxels = _coarse_voxels;
+	coarse_voxels.clear();
+	coarse_voxels.swap(_visible_voxels);
+	for (size_t v = 0; v < coarse_voxels.size(); ++v)
+	{
+		const Voxel* voxel = coarse_voxels[v];
+		if (!isBoundary((voxel->x + h_edge) / _step, (voxel->y + h_edge) / _step, voxel->z / _step))
+			_visible_voxels.push_back(coarse_voxels[v]);
+	}
+
+	const int sub_step = _step / _refine_factor;
+	const int sub_amount = _refine_factor * _refine_factor * _refine_factor;
+
+#ifdef PARALLEL_PROCESS
+#pragma omp parallel
+#endif
+	{
+		// Per thread scratch buffers, reused for every boundary voxel
+		vector<Point3f> centers(sub_amount);
+		vector<vector<Point> > projections(_cameras.size());
+		vector<Point2f> image_points;
+		vector<int> camera_counter(sub_amount);
+
+#ifdef PARALLEL_PROCESS
+#pragma omp for schedule(dynamic, 16)
+#endif
+		for (int b = 0; b < (int) boundary.size(); ++b)
 		{
+			const Voxel* voxel = _voxels[boundary[b]];
+
+			// The sub-voxel centers, the coarse voxel spans [x, x + step) like its grid cell
+			const int x0 = voxel->x + sub_step / 2;
+			const int y0 = voxel->y + sub_step / 2;
+			const int z0 = voxel->z + sub_step / 2;
+			for (int k = 0, s = 0; k < _refine_factor; ++k)
+				for (int j = 0; j < _refine_factor; ++j)
+					for (int i = 0; i < _refine_factor; ++i, ++s)
+						centers[s] = Point3f((float) (x0 + i * sub_step), (float) (y0 + j * sub_step), (float) (z0 + k * sub_step));
+
+			fill(camera_counter.begin(), camera_counter.end(), 0);
+			for (size_t c = 0; c < _cameras.size(); ++c)
+			{
+				_cameras[c]->projectOnView(centers, projections[c], image_points);
+
+				const Mat& foreground = _cameras[c]->getForegroundImage();
+				const PackedMask& packed_foreground = _cameras[c]->getPackedForeground();
+				for (size_t s = 0; s < centers.size(); ++s)
+				{
+					const Point point = projections[c][s];
+					if (point.x >= 0 && point.x < _plane_size.width && point.y >= 0 && point.y < _plane_size.height
+							&& (_packed ? packed_foreground.test(point.x, point.y) : foreground.at<uchar>(point) == 255))
+						++camera_counter[s];
+				}
+			}
+
 #ifdef PARALLEL_PROCESS
-#pragma omp critical //push_back is critical
+#pragma omp critical //the sub-voxel pool and push_back are critical
 #endif
-			_visible_voxels.push_back(voxel);
+			for (size_t s = 0; s < centers.size(); ++s)
+			{
+				if (camera_counter[s] != (int) _cameras.size()) continue;
+
+				Voxel* sub_voxel = acquireSubVoxel();
+				sub_voxel->x = (int) centers[s].x;
+				sub_voxel->y = (int) centers[s].y;
+				sub_voxel->z = (int) centers[s].z;
+				sub_voxel->size = sub_step;
+				sub_voxel->cluster = -1;
+				for (size_t c = 0; c < _cameras.size(); ++c)
+				{
+					sub_voxel->camera_projection[c] = projections[c][s];
+					sub_voxel->valid_camera_projection[c] = 1;
+					sub_voxel->occluded_from_camera[c] = false;
+				}
+				_visible_voxels.push_back(sub_voxel);
+			}
 		}
 	}
 }
@@ -7,6 +7,9 @@
 
 #include "Scene3DRenderer.h"
 
+#include "BackgroundModel.h"
+#include "Clustering.h"
+
 using namespace std;
 using namespace cv;
 
@@ -14,10 +17,12 @@ namespace nl_uu_science_gmt
 {
 
 /**
- * Scene properties class (mostly called by Glut)
+ * Scene properties class (mostly called by Glut), with its sliders on the video window
+ * unless 'controls' is false (without windows, eg. for a replay)
  */
-Scene3DRenderer::Scene3DRenderer(Reconstructor &r, const vector<Camera*> &cs) :
-		_reconstructor(r), _cameras(cs), _num(4), _sphere_radius(1850)
+Scene3DRenderer::Scene3DRenderer(Reconstructor &r, const vector<Camera*> &cs, bool controls) :
+		_reconstructor(r), _cameras(cs), _num(4), _sphere_radius(1850), _frame_cache((size_t) 256 << 20),
+				_bundle_source(cs)
 {
 	_width = 640;
 	_height = 480;
@@ -47,7 +52,7 @@ Scene3DRenderer::Scene3DRenderer(Reconstructor &r, const vector<Camera*> &cs) :
 	_current_camera = 0;
 	_previous_camera = 0;
 
-	_number_of_frames = _cameras.front()->getFramesAmount();
+	_number_of_frames = _bundle_source.getFramesAmount();
 	_current_frame = 0;
 	_previous_frame = -1;
 
@@ -62,15 +67,45 @@ Scene3DRenderer::Scene3DRenderer(Reconstructor &r, const vector<Camera*> &cs) :
 	_pv_threshold = V;
 	_e_factor = 2;
 	_d_factor = 2;
+	_band_width = 4;
+	_smoothness = 8;
+	_bg_model_type = BackgroundModel::STATIC;
+	_packed_masks = false;
+	_volume_roi = true;
+	_sparse_foreground = false;
+	_ycrcb_segmentation = false;
+	_live = false;
+	_threads = (int) _cameras.size();
+#ifdef DEBUG
+	_frame_allocations = 0;
+#endif
 
-	createTrackbar("Frame", VIDEO_WINDOW, &_current_frame, _number_of_frames - 2);
-	createTrackbar("Hue", VIDEO_WINDOW, &_h_threshold, 255);
-	createTrackbar("Saturation", VIDEO_WINDOW, &_s_threshold, 255);
-	createTrackbar("Value", VIDEO_WINDOW, &_v_threshold, 255);
-	createTrackbar("Erosion", VIDEO_WINDOW, &_e_factor, 20);
-	createTrackbar("Dilation", VIDEO_WINDOW, &_d_factor, 20);
+	if (controls)
+	{
+		createTrackbar("Frame", VIDEO_WINDOW, &_current_frame, _number_of_frames - 2);
+		createTrackbar("Hue", VIDEO_WINDOW, &_h_threshold, 255);
+		createTrackbar("Saturation", VIDEO_WINDOW, &_s_threshold, 255);
+		createTrackbar("Value", VIDEO_WINDOW, &_v_threshold, 255);
+#ifndef USE_GRAPHCUTS
+		createTrackbar("Erosion", VIDEO_WINDOW, &_e_factor, 20);
+		createTrackbar("Dilation", VIDEO_WINDOW, &_d_factor, 20);
+#else
+		createTrackbar("Band", VIDEO_WINDOW, &_band_width, 20);
+		createTrackbar("Smoothness", VIDEO_WINDOW, &_smoothness, 100);
+#endif
+		createTrackbar("Background", VIDEO_WINDOW, &_bg_model_type, BackgroundModel::TYPES_AMOUNT - 1);
+	}
 	createFloorGrid();
 	setTopView();
+
+	// The part of each camera's view the voxel volume can project to (the voxel cubes are
+	// [x, x + step) and stay within the volume corners)
+	const vector<Point3f*> &corners = _reconstructor.getCorners();
+	vector<Point3f> volume;
+	for (size_t i = 0; i < corners.size(); ++i)
+		volume.push_back(*corners[i]);
+	for (size_t c = 0; c < _cameras.size(); ++c)
+		_cameras[c]->setVolumeRoi(volume);
 }
 
 /**
@@ -85,62 +120,427 @@ Scene3DRenderer::~Scene3DRenderer()
 
 /**
  * Process the current frame on each camera
+ *
+ * The frames of all cameras are read as one bundle (decoded concurrently), so they're always
+ * the same frame number; with the SKIP policy that may be a later frame than the current one,
+ * which then becomes the current frame. False if the bundle was dropped (nothing processed).
+ *
+ * The cameras share no mutable state, so segmenting runs concurrently too (one task per
+ * camera, at most _threads at a time). The implicit barrier at the end of the loop
+ * guarantees all foreground images are done before carving.
  */
 bool Scene3DRenderer::processFrame()
 {
+	// Frames decoded before come from the cache, which doesn't change during the loop
+	const FrameCache::Entry* cached = _current_frame != _previous_frame ? _frame_cache.find(_current_frame) : NULL;
+	if (cached != NULL && cached->frames.size() != _cameras.size()) cached = NULL;
+
+	if (cached == NULL && _current_frame != _previous_frame)
+	{
+		const bool delivered = _bundle_source.read(_current_frame, _bundle);
+		_current_frame = _bundle.index;
+		if (!delivered) return false;
+	}
+
+#ifdef PARALLEL_PROCESS
+#pragma omp parallel for schedule(dynamic, 1) num_threads(max(1, _threads))
+#endif
+	for (int c = 0; c < (int) _cameras.size(); ++c)
+	{
+		if (cached != NULL) _cameras[c]->setFrame(cached->frames[c]);
+		processForeground(_cameras[c]);
+	}
+	return true;
+}
+
+/**
+ * Hash of everything the foreground masks, the carving and the clustering depend on
+ * (besides the frame itself), to tell whether cached derived products are still valid
+ */
+size_t Scene3DRenderer::getParameterHash() const
+{
+	size_t hash = 0;
+	hash = FrameCache::hash(hash, _h_threshold);
+	hash = FrameCache::hash(hash, _s_threshold);
+	hash = FrameCache::hash(hash, _v_threshold);
+	hash = FrameCache::hash(hash, _e_factor);
+	hash = FrameCache::hash(hash, _d_factor);
+	hash = FrameCache::hash(hash, _band_width);
+	hash = FrameCache::hash(hash, _smoothness);
+	hash = FrameCache::hash(hash, _bg_model_type);
+	hash = FrameCache::hash(hash, _packed_masks);
+	hash = FrameCache::hash(hash, _volume_roi);
+	hash = FrameCache::hash(hash, _sparse_foreground);
+	hash = FrameCache::hash(hash, _ycrcb_segmentation);
+	hash = FrameCache::hash(hash, _reconstructor.isFootprintMode());
+	hash = FrameCache::hash(hash, cvRound(_reconstructor.getFootprintFraction() * 1000));
+	hash = FrameCache::hash(hash, _reconstructor.getRefineFactor());
+	return hash;
+}
+
+/**
+ * Restore the current frame from the cache: the frames, foreground masks, visible voxels
+ * and their cluster colors, as processFrame, Reconstructor::update and Clustering::processFrame
+ * would have made them. False if it isn't cached with the current parameters.
+ */
+bool Scene3DRenderer::restoreFrame()
+{
+	FrameCache::Entry* entry = _frame_cache.getMaxBytes() > 0 ? _frame_cache.find(_current_frame) : NULL;
+	const bool hit = entry != NULL && entry->derived && entry->parameters == getParameterHash()
+			&& entry->frames.size() == _cameras.size();
+	_frame_cache.countHit(hit);
+	if (!hit) return false;
+
 	for (size_t c = 0; c < _cameras.size(); ++c)
 	{
-		if (_current_frame == _previous_frame + 1)
+		Camera::Workspace &workspace = _cameras[c]->getWorkspace();
+		_cameras[c]->setFrame(entry->frames[c]);
+		entry->foregrounds[c].copyTo(workspace.foreground);
+		workspace.sparse_mask = false;
+		_cameras[c]->setForegroundImage(workspace.foreground);
+		_cameras[c]->setForegroundPacked(false);
+	}
+
+	_reconstructor.setVisibleVoxels(entry->visible_voxels);
+	for (size_t v = 0; v < entry->visible_voxels.size(); ++v)
+	{
+		entry->visible_voxels[v]->color = entry->colors[v];
+		entry->visible_voxels[v]->cluster = entry->clusters[v];
+	}
+	return true;
+}
+
+/**
+ * Cache the current frame after it was processed. The derived products are only kept if
+ * they only depend on this frame: not with an adaptive background model (it depends on
+ * the frames before) nor with sub-voxel refinement (its voxels are reused every frame).
+ */
+void Scene3DRenderer::storeFrame()
+{
+	if (_frame_cache.getMaxBytes() == 0) return;
+
+	FrameCache::Entry &entry = _frame_cache.insert(_current_frame);
+	entry.frames.resize(_cameras.size());
+	entry.foregrounds.resize(_cameras.size());
+	for (size_t c = 0; c < _cameras.size(); ++c)
+		_cameras[c]->getFrame().copyTo(entry.frames[c]);
+
+	entry.derived = _bg_model_type == BackgroundModel::STATIC && _reconstructor.getRefineFactor() == 1;
+	if (entry.derived)
+	{
+		entry.parameters = getParameterHash();
+		for (size_t c = 0; c < _cameras.size(); ++c)
 		{
-			_cameras[c]->advanceVideoFrame();
+			if (_cameras[c]->isForegroundPacked())
+				_cameras[c]->getPackedForeground().unpack(entry.foregrounds[c]);
+			else
+				_cameras[c]->getForegroundImage().copyTo(entry.foregrounds[c]);
 		}
-		else if (_current_frame != _previous_frame)
+
+		const vector<Reconstructor::Voxel*> &voxels = _reconstructor.getVisibleVoxels();
+		entry.visible_voxels.assign(voxels.begin(), voxels.end());
+		entry.colors.resize(voxels.size());
+		entry.clusters.resize(voxels.size());
+		for (size_t v = 0; v < voxels.size(); ++v)
 		{
-			_cameras[c]->getVideoFrame(_current_frame);
+			entry.colors[v] = voxels[v]->color;
+			entry.clusters[v] = voxels[v]->cluster;
 		}
-		processForeground(_cameras[c]);
 	}
-	return true;
+	_frame_cache.commit(entry);
+}
+
+/**
+ * Live: move to the newest frame by the clock (replaying from the start after the end), the
+ * frames the processing didn't get to are dropped. The clock starts at the frame after the
+ * current one.
+ */
+void Scene3DRenderer::advanceLive()
+{
+	const double fps = _cameras.front()->getFps();
+	if (!_live_scheduler.isRunning()) _live_scheduler.start(_current_frame + 1, fps);
+	int due = _live_scheduler.getDueFrame();
+	if (due > _number_of_frames - 2)
+	{
+		_live_scheduler.start(0, fps);
+		due = 0;
+	}
+	if (due != _current_frame) _live_scheduler.drop(due - _current_frame - 1);
+	_current_frame = due;
+}
+
+/**
+ * Process the current frame: segmentation, carving and clustering, then cache it. Live (and
+ * not paused) the stages are timed by the live scheduler from beginFrame() on, the clustering
+ * only runs if there's still time (without it the frame isn't cached). Returns whether there's
+ * time to render the frame (always when not live); the caller ends the live frame.
+ */
+bool Scene3DRenderer::processStages(Clustering &clustering)
+{
+	const bool live = _live && !_paused;
+	if (live) _live_scheduler.beginFrame(_current_frame);
+#ifdef DEBUG
+	const size_t allocations = General::getAllocations();
+	_frame_allocations = 0;
+#endif
+
+	if (!processFrame()) return true;  // the bundle was dropped, the last frame stays
+	if (live) _live_scheduler.endStage(LiveScheduler::SEGMENTATION);
+	_reconstructor.update();
+	if (live) _live_scheduler.endStage(LiveScheduler::CARVING);
+	// Added clustering step, to set the color of the voxels (live: if there's still time)
+	const bool cluster = !live || _live_scheduler.admit(LiveScheduler::CLUSTERING);
+	if (cluster) clustering.processFrame();
+	if (live && cluster) _live_scheduler.endStage(LiveScheduler::CLUSTERING);
+#ifdef DEBUG
+	_frame_allocations = General::getAllocations() - allocations;  // by segmentation, carving and clustering
+#endif
+
+	// Without clustering the voxel colors are stale, that's not worth caching
+	if (cluster) storeFrame();
+	return !live || _live_scheduler.admit(LiveScheduler::RENDERING);
+}
+
+/**
+ * Segment the current frames again after a threshold changed (the frame itself didn't)
+ *
+ * The static HSV subtraction keeps the per camera background differences of the frame,
+ * so only the thresholding and the noise removal run again, not the color conversion
+ */
+void Scene3DRenderer::processThresholds()
+{
+#ifdef PARALLEL_PROCESS
+#pragma omp parallel for schedule(dynamic, 1) num_threads(max(1, _threads))
+#endif
+	for (int c = 0; c < (int) _cameras.size(); ++c)
+		processForeground(_cameras[c], true);
 }
 
 /**
  * Separate the background from the foreground
  * ie.: Create an 8 bit image where only the foreground of the scene is white
+ *
+ * With 'thresholds_only' the frame is the same as the last call's, so the static HSV
+ * subtraction thresholds the camera's cached background differences
  */
-void Scene3DRenderer::processForeground(Camera* camera)
+void Scene3DRenderer::processForeground(Camera* camera, bool thresholds_only)
 {
-	Mat hsv_image;
-	cvtColor(camera->getFrame(), hsv_image, CV_BGR2HSV);  // from BGR to HSV color space
+	// All intermediate images live in the camera's workspace, so no buffers get allocated per frame
+	Camera::Workspace &workspace = camera->getWorkspace();
 
-	vector<Mat> channels;
-	split(hsv_image, channels);  // Split the HSV-channels for further analysis
+	// With packed masks the foreground stays 1 bit per pixel from the subtraction up to the
+	// carving, except through the graph cut which works on 8-bit masks
+#ifndef USE_GRAPHCUTS
+	const bool packed = _packed_masks;
+#else
+	const bool packed = false;
+#endif
 
-	// Background subtraction H
-	Mat tmp, foreground, background;
-	absdiff(channels[0], camera->getBgHsvChannels().at(0), tmp);
-	threshold(tmp, foreground, _h_threshold, 255, CV_THRESH_BINARY);
+	// Sparse evaluation: when the carving only reads the voxels' center pixels (no footprint test,
+	// no refinement) only those pixels are segmented, with a majority vote instead of the noise
+	// removal. It needs the static background, otherwise the full frame is segmented.
+	if (_sparse_foreground && _bg_model_type == BackgroundModel::STATIC && !_reconstructor.isFootprintMode()
+			&& _reconstructor.getRefineFactor() == 1)
+	{
+		// The pixels in between are never written, so clear them once when switching to sparse
+		if (!workspace.sparse_mask)
+		{
+			workspace.foreground.create(camera->getSize(), CV_8U);
+			workspace.foreground.setTo(Scalar::all(0));
+			workspace.sparse_mask = true;
+		}
+		Foreground::subtractHSVSparse(camera->getFrame(), camera->getBgHsvImage(), camera->getBgHsvDeviation(),
+				_h_threshold, _s_threshold, _v_threshold, _reconstructor.getReferencedPixels(camera->getId()),
+				workspace.sparse_memo, workspace.sparse_generation, workspace.foreground);
 
-	// Background subtraction S
-	absdiff(channels[1], camera->getBgHsvChannels().at(1), tmp);
-	threshold(tmp, background, _s_threshold, 255, CV_THRESH_BINARY);
-	bitwise_and(foreground, background, foreground);
+		camera->setForegroundImage(workspace.foreground);
+		camera->setForegroundPacked(false);
+		return;
+	}
+	workspace.sparse_mask = false;
+
+	// Only segment the part of the view the voxel volume projects to, grown by the noise removal
+	// reach (+1 for the region's own border) so the result within the projection stays exact
+#ifndef USE_GRAPHCUTS
+	const int margin = _e_factor + _d_factor + 1;
+#else
+	const int margin = _band_width + 1;
+#endif
+	const vector<Range>* roi = _volume_roi ? &camera->getRoi(margin) : NULL;
+	if (roi != NULL && roi->empty()) roi = NULL;
+	const Rect roi_rect = roi != NULL ? camera->getRoiRect() : Rect(Point(0, 0), camera->getSize());
+
+	if (_bg_model_type == BackgroundModel::STATIC && _ycrcb_segmentation)
+	{
+		// Background subtraction luma OR chroma (thresholds of the Value and Saturation sliders),
+		// cheaper to convert to than HSV. The HSV frame is only converted if a later stage asks.
+		if (packed)
+			Foreground::subtractYCrCb(camera->getFrame(), camera->getBgYCrCbImage(), _v_threshold, _s_threshold,
+					workspace.packed_subtraction, roi);
+		else
+			Foreground::subtractYCrCb(camera->getFrame(), camera->getBgYCrCbImage(), _v_threshold, _s_threshold,
+					workspace.subtraction, roi);
+	}
+	else if (_bg_model_type == BackgroundModel::STATIC && thresholds_only)
+	{
+		// The same background subtraction, split in the differences (once per frame, full frame
+		// so they stay valid when the region of interest changes) and the thresholding
+		if (!workspace.difference_valid)
+		{
+			Foreground::differenceHSV(camera->getFrame(), camera->getBgHsvImage(), camera->getBgHsvDeviation(),
+					workspace.difference, workspace.hsv_frame);
+			camera->setHsvFrame(workspace.hsv_frame);
+			workspace.difference_valid = true;
+		}
+		if (packed)
+			Foreground::thresholdHSV(workspace.difference, _h_threshold, _s_threshold, _v_threshold,
+					workspace.packed_subtraction, roi);
+		else
+			Foreground::thresholdHSV(workspace.difference, _h_threshold, _s_threshold, _v_threshold,
+					workspace.subtraction, roi);
+	}
+	else if (_bg_model_type == BackgroundModel::STATIC)
+	{
+		// Background subtraction (H AND S) OR V, fused into a single pass over the frame
+		// that also leaves the HSV frame on the camera for the other stages (within the region
+		// of interest, the camera converts the rest only if a stage asks for it)
+		if (packed)
+			Foreground::subtractHSV(camera->getFrame(), camera->getBgHsvImage(), camera->getBgHsvDeviation(),
+					_h_threshold, _s_threshold, _v_threshold, workspace.packed_subtraction, workspace.hsv_frame, roi);
+		else
+			Foreground::subtractHSV(camera->getFrame(), camera->getBgHsvImage(), camera->getBgHsvDeviation(),
+					_h_threshold, _s_threshold, _v_threshold, workspace.subtraction, workspace.hsv_frame, roi);
+		camera->setHsvFrame(workspace.hsv_frame, roi);
+	}
+	else
+	{
+		// (Re)create the camera's adaptive model when another type was selected
+		const BackgroundModel::Type type = (BackgroundModel::Type) _bg_model_type;
+		if (camera->getBackgroundModel() == NULL || camera->getBackgroundModel()->getType() != type)
+		{
+			camera->setBackgroundModel(BackgroundModel::create(type, camera->getBgHsvImage()));
+#ifdef PARALLEL_PROCESS
+#pragma omp critical //cout is shared
+#endif
+			cout << "Camera " << camera->getId() + 1 << " background model: " << BackgroundModel::getTypeName(type)
+					<< endl;
+		}
 
-	// Background subtraction V
-	absdiff(channels[2], camera->getBgHsvChannels().at(2), tmp);
-	threshold(tmp, background, _v_threshold, 255, CV_THRESH_BINARY);
-	bitwise_or(foreground, background, foreground);
+		// Only learn from new frames, not when re-processing the same frame (eg. a threshold changed)
+		const bool learn = _current_frame != _previous_frame;
+		camera->getBackgroundModel()->apply(camera->getHsvFrame(), _h_threshold, _s_threshold, _v_threshold, learn,
+				workspace.subtraction);
+		if (packed) workspace.packed_subtraction.pack(workspace.subtraction);
+	}
 
 	// Remove noise
 #ifndef USE_GRAPHCUTS
-	// Using Erosion and/or Dilation of the foreground image
-	erode(foreground, tmp, Mat(), Point(-1,-1), _e_factor);
-	dilate(tmp, foreground, Mat(), Point(-1,-1), _d_factor);
+	// Using Erosion and/or Dilation of the foreground image, with a (2 * factor + 1) square
+	// (the same as factor 3x3 iterations, but at a cost independent of the factor)
+	if (packed)
+	{
+		workspace.filter.erode(workspace.packed_subtraction, workspace.packed_morphology, _e_factor);
+		workspace.filter.dilate(workspace.packed_morphology, workspace.packed_foreground, _d_factor);
+	}
+	else
+	{
+		// Within the bounding box of the region only, outside it nothing is foreground
+		Mat &foreground = workspace.foreground;
+		workspace.morphology.create(workspace.subtraction.size(), CV_8U);
+		foreground.create(workspace.subtraction.size(), CV_8U);
+
+		Mat subtraction_roi = workspace.subtraction(roi_rect);
+		Mat morphology_roi = workspace.morphology(roi_rect);
+		Mat foreground_roi = foreground(roi_rect);
+		workspace.filter.erode(subtraction_roi, morphology_roi, _e_factor);
+		workspace.filter.dilate(morphology_roi, foreground_roi, _d_factor);
+
+		const Range roi_rows(roi_rect.y, roi_rect.y + roi_rect.height);
+		foreground.rowRange(0, roi_rows.start).setTo(Scalar::all(0));
+		foreground.rowRange(roi_rows.end, foreground.rows).setTo(Scalar::all(0));
+		foreground(roi_rows, Range(0, roi_rect.x)).setTo(Scalar::all(0));
+		foreground(roi_rows, Range(roi_rect.x + roi_rect.width, foreground.cols)).setTo(Scalar::all(0));
+	}
 
 #else
-	// Using Graph cuts on the foreground image
+	// Using Graph cuts on the foreground image, only in a band around the thresholded silhouette
+	const Mat* background = &camera->getBgHsvImage();
+	if (camera->getBackgroundModel() != NULL && _bg_model_type != BackgroundModel::STATIC)
+	{
+		camera->getBackgroundModel()->getBackground(workspace.background);
+		background = &workspace.background;
+	}
+	workspace.graph_cut.segment(workspace.subtraction, camera->getHsvFrame(), *background, _h_threshold, _s_threshold,
+			_v_threshold, _band_width, _smoothness, workspace.foreground);
+	if (_packed_masks) workspace.packed_foreground.pack(workspace.foreground);
 #endif
 
-	camera->setForegroundImage(foreground);
+	camera->setForegroundImage(workspace.foreground);
+	camera->setForegroundPacked(_packed_masks);
+}
+
+/**
+ * Benchmark the sparse foreground evaluation against the full-frame segmentation (subtraction,
+ * erosion and dilation, without region of interest) on the cameras' current frames, for a
+ * range of voxel steps. A smaller step references more pixels, so this prints the time per
+ * frame of both and the smallest step at which the sparse evaluation is still the faster one.
+ */
+void Scene3DRenderer::benchmarkSparseForeground(int repetitions)
+{
+	const int steps[] = { 128, 96, 64, 48, 32, 24, 16 };
+	const int steps_amount = sizeof(steps) / sizeof(steps[0]);
+	const double ms = 1000.0 / getTickFrequency();
+
+	Mat subtraction, morphology, hsv;
+	vector<Mat> masks(_cameras.size());
+	Morphology filter;
+
+	int64 ticks = getTickCount();
+	for (int r = 0; r < repetitions; ++r)
+	{
+		for (size_t c = 0; c < _cameras.size(); ++c)
+		{
+			Foreground::subtractHSV(_cameras[c]->getFrame(), _cameras[c]->getBgHsvImage(),
+					_cameras[c]->getBgHsvDeviation(), _h_threshold, _s_threshold, _v_threshold, subtraction, hsv);
+			filter.erode(subtraction, morphology, _e_factor);
+			filter.dilate(morphology, masks[c], _d_factor);
+		}
+	}
+	const double full = (getTickCount() - ticks) * ms / repetitions;
+
+	cout << "Sparse foreground benchmark (" << _cameras.size() << " cameras, " << repetitions << " frames)" << endl;
+	cout << "step\tpixels\tfull ms\tsparse ms" << endl;
+
+	int crossover = -1;
+	vector<vector<int> > referenced_pixels;
+	vector<unsigned int> memo;
+	unsigned int generation = 0;
+	for (int i = 0; i < steps_amount; ++i)
+	{
+		Reconstructor::findReferencedPixels(_cameras, _reconstructor.getSize(), steps[i], referenced_pixels);
+		size_t pixels = 0;
+		for (size_t c = 0; c < _cameras.size(); ++c)
+		{
+			pixels += referenced_pixels[c].size();
+			masks[c].setTo(Scalar::all(0));
+		}
+
+		ticks = getTickCount();
+		for (int r = 0; r < repetitions; ++r)
+			for (size_t c = 0; c < _cameras.size(); ++c)
+				Foreground::subtractHSVSparse(_cameras[c]->getFrame(), _cameras[c]->getBgHsvImage(),
+						_cameras[c]->getBgHsvDeviation(), _h_threshold, _s_threshold, _v_threshold, referenced_pixels[c],
+						memo, generation, masks[c]);
+		const double sparse = (getTickCount() - ticks) * ms / repetitions;
+
+		cout << steps[i] << "\t" << pixels / _cameras.size() << "\t" << full << "\t" << sparse << endl;
+		if (sparse < full) crossover = steps[i];
+	}
+
+	if (crossover > 0)
+		cout << "Sparse evaluation is faster down to a step of " << crossover << endl;
+	else
+		cout << "Sparse evaluation is slower at every step" << endl;
 }
 
 /**
@@ -0,0 +1,104 @@
+/*
+ * ColorSpace.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "ColorSpace.h"
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+int ColorSpace::_SDivTable[256];
+int ColorSpace::_HDivTable[256];
+const bool ColorSpace::_TablesInitialized = ColorSpace::initTables();
+
+/**
+ * Fill the reciprocal tables the same way OpenCV does
+ */
+bool ColorSpace::initTables()
+{
+	_SDivTable[0] = _HDivTable[0] = 0;
+	for (int i = 1; i < 256; ++i)
+	{
+		_SDivTable[i] = cvRound((255 << HSV_SHIFT) / (1. * i));
+		_HDivTable[i] = cvRound((180 << HSV_SHIFT) / (6. * i));
+	}
+	return true;
+}
+
+/**
+ * Convert a BGR image to HSV with the integer path, the result is identical to cvtColor(CV_BGR2HSV)
+ */
+void ColorSpace::bgrToHsv(const Mat &bgr_image, Mat &hsv_image)
+{
+	assert(_TablesInitialized);
+	assert(bgr_image.type() == CV_8UC3);
+
+	hsv_image.create(bgr_image.size(), CV_8UC3);
+
+	for (int y = 0; y < bgr_image.rows; ++y)
+	{
+		const uchar* bgr = bgr_image.ptr<uchar>(y);
+		uchar* hsv = hsv_image.ptr<uchar>(y);
+
+		for (int x = 0; x < bgr_image.cols; ++x, bgr += 3, hsv += 3)
+		{
+			int h, s, v;
+			bgrToHsv(bgr[0], bgr[1], bgr[2], h, s, v);
+			hsv[0] = (uchar) h;
+			hsv[1] = (uchar) s;
+			hsv[2] = (uchar) v;
+		}
+	}
+}
+
+/**
+ * Convert the columns 'span' of row 'y' of a BGR image to HSV, into an HSV image of the same size
+ */
+void ColorSpace::bgrToHsv(const Mat &bgr_image, Mat &hsv_image, int y, const Range &span)
+{
+	assert(_TablesInitialized);
+	assert(bgr_image.type() == CV_8UC3 && hsv_image.type() == CV_8UC3 && bgr_image.size() == hsv_image.size());
+
+	const uchar* bgr = bgr_image.ptr<uchar>(y) + 3 * span.start;
+	uchar* hsv = hsv_image.ptr<uchar>(y) + 3 * span.start;
+	for (int x = span.start; x < span.end; ++x, bgr += 3, hsv += 3)
+	{
+		int h, s, v;
+		bgrToHsv(bgr[0], bgr[1], bgr[2], h, s, v);
+		hsv[0] = (uchar) h;
+		hsv[1] = (uchar) s;
+		hsv[2] = (uchar) v;
+	}
+}
+
+/**
+ * Convert a BGR image to YCrCb with the integer path, the result is identical to cvtColor(CV_BGR2YCrCb)
+ */
+void ColorSpace::bgrToYCrCb(const Mat &bgr_image, Mat &ycrcb_image)
+{
+	assert(bgr_image.type() == CV_8UC3);
+
+	ycrcb_image.create(bgr_image.size(), CV_8UC3);
+
+	for (int y = 0; y < bgr_image.rows; ++y)
+	{
+		const uchar* bgr = bgr_image.ptr<uchar>(y);
+		uchar* ycrcb = ycrcb_image.ptr<uchar>(y);
+
+		for (int x = 0; x < bgr_image.cols; ++x, bgr += 3, ycrcb += 3)
+		{
+			int l, cr, cb;
+			bgrToYCrCb(bgr[0], bgr[1], bgr[2], l, cr, cb);
+			ycrcb[0] = (uchar) l;
+			ycrcb[1] = (uchar) cr;
+			ycrcb[2] = (uchar) cb;
+		}
+	}
+}
+
+} /* namespace nl_uu_science_gmt */
@@ -0,0 +1,370 @@
+/*
+ * Foreground.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "Foreground.h"
+
+#include <cstring>
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+/**
+ * Convert one BGR pixel to HSV (written to hsv) and return whether it is foreground:
+ * background subtraction (H AND S) OR V. A channel differs if its distance is larger than
+ * both the threshold and the background's noise bg_deviation at this pixel.
+ */
+static inline bool subtractPixel(const uchar* bgr, const uchar* bg_hsv, const uchar* bg_deviation, uchar* hsv,
+		int h_threshold, int s_threshold, int v_threshold)
+{
+	int h, s, v;
+	ColorSpace::bgrToHsv(bgr[0], bgr[1], bgr[2], h, s, v);
+	hsv[0] = (uchar) h;
+	hsv[1] = (uchar) s;
+	hsv[2] = (uchar) v;
+
+	const bool h_fg = abs(h - bg_hsv[0]) > max(h_threshold, (int) bg_deviation[0]);
+	const bool s_fg = abs(s - bg_hsv[1]) > max(s_threshold, (int) bg_deviation[1]);
+	const bool v_fg = abs(v - bg_hsv[2]) > max(v_threshold, (int) bg_deviation[2]);
+
+	return (h_fg & s_fg) | v_fg;
+}
+
+/**
+ * Convert one BGR pixel to YCrCb and return whether it differs from the background YCrCb
+ * bg_ycrcb in luma or chroma, tolerating shadows:
+ *  - a shadow darkens the background and pulls its chroma towards neutral (128) by the same
+ *    fraction, so a darker pixel's chroma threshold grows by that expected shift
+ *  - a darker pixel only counts by its luma if it's darker than a shadow makes it (< half)
+ * All in integers without divisions (the shift is compared multiplied by the background luma)
+ */
+static inline bool subtractPixelYCrCb(const uchar* bgr, const uchar* bg_ycrcb, int l_threshold, int c_threshold)
+{
+	int l, cr, cb;
+	ColorSpace::bgrToYCrCb(bgr[0], bgr[1], bgr[2], l, cr, cb);
+
+	const int bg_l = bg_ycrcb[0] + 1;
+	const int darkening = max(0, bg_ycrcb[0] - l);
+	const int chroma = abs(cr - bg_ycrcb[1]) + abs(cb - bg_ycrcb[2]);
+	const int bg_chroma = abs(bg_ycrcb[1] - 128) + abs(bg_ycrcb[2] - 128);
+
+	const bool l_fg = l - bg_ycrcb[0] > l_threshold || (darkening > l_threshold && 2 * l < bg_ycrcb[0]);
+	const bool c_fg = chroma * bg_l > c_threshold * bg_l + bg_chroma * darkening;
+
+	return l_fg | c_fg;
+}
+
+/**
+ * Background subtraction in HSV-color space in a single pass
+ *
+ * Reads the BGR frame and the interleaved background HSV image once, converts each
+ * pixel to HSV (bit-exact with cvtColor), thresholds the H, S and V differences and
+ * writes the (H AND S) OR V foreground mask. The converted HSV frame is written as a
+ * by-product, so other stages don't have to convert the frame again. The only
+ * allocations are the outputs themselves, and only if they don't have the right size
+ * and type yet.
+ *
+ * With a region of interest (per row a column span) only the pixels inside it are
+ * processed: outside it the mask is 0 and the HSV image is left as it was.
+ */
+void Foreground::subtractHSV(const Mat &bgr_image, const Mat &bg_hsv_image, const Mat &bg_deviation_image,
+		int h_threshold, int s_threshold, int v_threshold, Mat &foreground, Mat &hsv_image, const vector<Range>* roi)
+{
+	assert(bgr_image.type() == CV_8UC3 && bg_hsv_image.type() == CV_8UC3 && bg_deviation_image.type() == CV_8UC3);
+	assert(bgr_image.size() == bg_hsv_image.size() && bgr_image.size() == bg_deviation_image.size());
+
+	foreground.create(bgr_image.size(), CV_8U);
+	hsv_image.create(bgr_image.size(), CV_8UC3);
+
+	for (int y = 0; y < bgr_image.rows; ++y)
+	{
+		const uchar* bgr = bgr_image.ptr<uchar>(y);
+		const uchar* bg_hsv = bg_hsv_image.ptr<uchar>(y);
+		const uchar* bg_deviation = bg_deviation_image.ptr<uchar>(y);
+		uchar* hsv = hsv_image.ptr<uchar>(y);
+		uchar* mask = foreground.ptr<uchar>(y);
+
+		const Range span = roi != NULL && !roi->empty() ? (*roi)[y] : Range(0, bgr_image.cols);
+		memset(mask, 0, span.start);
+		memset(mask + span.end, 0, bgr_image.cols - span.end);
+		bgr += 3 * span.start;
+		bg_hsv += 3 * span.start;
+		bg_deviation += 3 * span.start;
+		hsv += 3 * span.start;
+
+		for (int x = span.start; x < span.end; ++x, bgr += 3, bg_hsv += 3, bg_deviation += 3, hsv += 3)
+			mask[x] = subtractPixel(bgr, bg_hsv, bg_deviation, hsv, h_threshold, s_threshold, v_threshold) ? 255 : 0;
+	}
+}
+
+/**
+ * The same single pass background subtraction, writing a bit-packed foreground mask
+ * (one word store per 64 pixels instead of a byte per pixel)
+ */
+void Foreground::subtractHSV(const Mat &bgr_image, const Mat &bg_hsv_image, const Mat &bg_deviation_image,
+		int h_threshold, int s_threshold, int v_threshold, PackedMask &foreground, Mat &hsv_image,
+		const vector<Range>* roi)
+{
+	assert(bgr_image.type() == CV_8UC3 && bg_hsv_image.type() == CV_8UC3 && bg_deviation_image.type() == CV_8UC3);
+	assert(bgr_image.size() == bg_hsv_image.size() && bgr_image.size() == bg_deviation_image.size());
+
+	foreground.create(bgr_image.rows, bgr_image.cols);
+	hsv_image.create(bgr_image.size(), CV_8UC3);
+
+	for (int y = 0; y < bgr_image.rows; ++y)
+	{
+		const uchar* bgr = bgr_image.ptr<uchar>(y);
+		const uchar* bg_hsv = bg_hsv_image.ptr<uchar>(y);
+		const uchar* bg_deviation = bg_deviation_image.ptr<uchar>(y);
+		uchar* hsv = hsv_image.ptr<uchar>(y);
+		uint64_t* words = foreground.row(y);
+
+		const Range span = roi != NULL && !roi->empty() ? (*roi)[y] : Range(0, bgr_image.cols);
+		for (int w = 0; w < foreground.getWordsPerRow(); ++w)
+		{
+			const int x0 = max(span.start, w * PackedMask::WORD_BITS);
+			const int x1 = min(span.end, (w + 1) * PackedMask::WORD_BITS);
+
+			uint64_t word = 0;
+			for (int x = x0; x < x1; ++x)
+				word |= (uint64_t) subtractPixel(bgr + 3 * x, bg_hsv + 3 * x, bg_deviation + 3 * x, hsv + 3 * x,
+						h_threshold, s_threshold, v_threshold) << (x % PackedMask::WORD_BITS);
+			words[w] = word;
+		}
+	}
+}
+
+/**
+ * The threshold independent half of subtractHSV: convert the frame to HSV and store the
+ * per channel absolute difference with the background (interleaved |dH|, |dS|, |dV|),
+ * so changing the thresholds only needs thresholdHSV(). Differences within the
+ * background's noise are stored as 0, as no threshold makes them differ.
+ */
+void Foreground::differenceHSV(const Mat &bgr_image, const Mat &bg_hsv_image, const Mat &bg_deviation_image,
+		Mat &difference, Mat &hsv_image)
+{
+	assert(bgr_image.type() == CV_8UC3 && bg_hsv_image.type() == CV_8UC3 && bg_deviation_image.type() == CV_8UC3);
+	assert(bgr_image.size() == bg_hsv_image.size() && bgr_image.size() == bg_deviation_image.size());
+
+	difference.create(bgr_image.size(), CV_8UC3);
+	hsv_image.create(bgr_image.size(), CV_8UC3);
+
+	for (int y = 0; y < bgr_image.rows; ++y)
+	{
+		const uchar* bgr = bgr_image.ptr<uchar>(y);
+		const uchar* bg_hsv = bg_hsv_image.ptr<uchar>(y);
+		const uchar* bg_deviation = bg_deviation_image.ptr<uchar>(y);
+		uchar* hsv = hsv_image.ptr<uchar>(y);
+		uchar* diff = difference.ptr<uchar>(y);
+
+		for (int x = 0; x < bgr_image.cols; ++x, bgr += 3, bg_hsv += 3, bg_deviation += 3, hsv += 3, diff += 3)
+		{
+			int h, s, v;
+			ColorSpace::bgrToHsv(bgr[0], bgr[1], bgr[2], h, s, v);
+			hsv[0] = (uchar) h;
+			hsv[1] = (uchar) s;
+			hsv[2] = (uchar) v;
+
+			const int dh = abs(h - bg_hsv[0]), ds = abs(s - bg_hsv[1]), dv = abs(v - bg_hsv[2]);
+			diff[0] = (uchar) (dh > bg_deviation[0] ? dh : 0);
+			diff[1] = (uchar) (ds > bg_deviation[1] ? ds : 0);
+			diff[2] = (uchar) (dv > bg_deviation[2] ? dv : 0);
+		}
+	}
+}
+
+/**
+ * The threshold half of subtractHSV on a differenceHSV() image: (H AND S) OR V, identical
+ * to subtractHSV with the same thresholds and region of interest
+ */
+void Foreground::thresholdHSV(const Mat &difference, int h_threshold, int s_threshold, int v_threshold,
+		Mat &foreground, const vector<Range>* roi)
+{
+	assert(difference.type() == CV_8UC3);
+
+	foreground.create(difference.size(), CV_8U);
+
+	for (int y = 0; y < difference.rows; ++y)
+	{
+		const uchar* diff = difference.ptr<uchar>(y);
+		uchar* mask = foreground.ptr<uchar>(y);
+
+		const Range span = roi != NULL && !roi->empty() ? (*roi)[y] : Range(0, difference.cols);
+		memset(mask, 0, span.start);
+		memset(mask + span.end, 0, difference.cols - span.end);
+		diff += 3 * span.start;
+
+		for (int x = span.start; x < span.end; ++x, diff += 3)
+			mask[x] = ((diff[0] > h_threshold) & (diff[1] > s_threshold)) | (diff[2] > v_threshold) ? 255 : 0;
+	}
+}
+
+/**
+ * The same thresholding, writing a bit-packed foreground mask
+ */
+void Foreground::thresholdHSV(const Mat &difference, int h_threshold, int s_threshold, int v_threshold,
+		PackedMask &foreground, const vector<Range>* roi)
+{
+	assert(difference.type() == CV_8UC3);
+
+	foreground.create(difference.rows, difference.cols);
+
+	for (int y = 0; y < difference.rows; ++y)
+	{
+		const uchar* diff = difference.ptr<uchar>(y);
+		uint64_t* words = foreground.row(y);
+
+		const Range span = roi != NULL && !roi->empty() ? (*roi)[y] : Range(0, difference.cols);
+		for (int w = 0; w < foreground.getWordsPerRow(); ++w)
+		{
+			const int x0 = max(span.start, w * PackedMask::WORD_BITS);
+			const int x1 = min(span.end, (w + 1) * PackedMask::WORD_BITS);
+
+			uint64_t word = 0;
+			for (int x = x0; x < x1; ++x)
+			{
+				const uchar* d = diff + 3 * x;
+				word |= (uint64_t) (((d[0] > h_threshold) & (d[1] > s_threshold)) | (d[2] > v_threshold))
+						<< (x % PackedMask::WORD_BITS);
+			}
+			words[w] = word;
+		}
+	}
+}
+
+/**
+ * Background subtraction in YCrCb-color space in a single pass: luma OR chroma distance,
+ * with the shadow tolerance of subtractPixelYCrCb()
+ *
+ * The conversion is a handful of integer multiply-adds per pixel, much cheaper than HSV's
+ * min/max, divisions and hue branches. No HSV frame is produced, stages that need one
+ * convert it on demand (Camera::getHsvFrame). Same region of interest handling as subtractHSV.
+ */
+void Foreground::subtractYCrCb(const Mat &bgr_image, const Mat &bg_ycrcb_image, int l_threshold, int c_threshold,
+		Mat &foreground, const vector<Range>* roi)
+{
+	assert(bgr_image.type() == CV_8UC3 && bg_ycrcb_image.type() == CV_8UC3);
+	assert(bgr_image.size() == bg_ycrcb_image.size());
+
+	foreground.create(bgr_image.size(), CV_8U);
+
+	for (int y = 0; y < bgr_image.rows; ++y)
+	{
+		const uchar* bgr = bgr_image.ptr<uchar>(y);
+		const uchar* bg_ycrcb = bg_ycrcb_image.ptr<uchar>(y);
+		uchar* mask = foreground.ptr<uchar>(y);
+
+		const Range span = roi != NULL && !roi->empty() ? (*roi)[y] : Range(0, bgr_image.cols);
+		memset(mask, 0, span.start);
+		memset(mask + span.end, 0, bgr_image.cols - span.end);
+		bgr += 3 * span.start;
+		bg_ycrcb += 3 * span.start;
+
+		for (int x = span.start; x < span.end; ++x, bgr += 3, bg_ycrcb += 3)
+			mask[x] = subtractPixelYCrCb(bgr, bg_ycrcb, l_threshold, c_threshold) ? 255 : 0;
+	}
+}
+
+/**
+ * The same YCrCb background subtraction, writing a bit-packed foreground mask
+ */
+void Foreground::subtractYCrCb(const Mat &bgr_image, const Mat &bg_ycrcb_image, int l_threshold, int c_threshold,
+		PackedMask &foreground, const vector<Range>* roi)
+{
+	assert(bgr_image.type() == CV_8UC3 && bg_ycrcb_image.type() == CV_8UC3);
+	assert(bgr_image.size() == bg_ycrcb_image.size());
+
+	foreground.create(bgr_image.rows, bgr_image.cols);
+
+	for (int y = 0; y < bgr_image.rows; ++y)
+	{
+		const uchar* bgr = bgr_image.ptr<uchar>(y);
+		const uchar* bg_ycrcb = bg_ycrcb_image.ptr<uchar>(y);
+		uint64_t* words = foreground.row(y);
+
+		const Range span = roi != NULL && !roi->empty() ? (*roi)[y] : Range(0, bgr_image.cols);
+		for (int w = 0; w < foreground.getWordsPerRow(); ++w)
+		{
+			const int x0 = max(span.start, w * PackedMask::WORD_BITS);
+			const int x1 = min(span.end, (w + 1) * PackedMask::WORD_BITS);
+
+			uint64_t word = 0;
+			for (int x = x0; x < x1; ++x)
+				word |= (uint64_t) subtractPixelYCrCb(bgr + 3 * x, bg_ycrcb + 3 * x, l_threshold, c_threshold)
+						<< (x % PackedMask::WORD_BITS);
+			words[w] = word;
+		}
+	}
+}
+
+/**
+ * Background subtraction at the given pixels only (offsets in the continuous frame),
+ * for when the consumer reads just a sparse set of pixels (eg. the voxel projections)
+ *
+ * Instead of the erosion/dilation, which would need the whole neighborhood of every
+ * pixel, each given pixel becomes foreground if the majority of its 3x3 neighborhood
+ * (within the image) is. The subtraction of a pixel is computed lazily and memoized in
+ * 'memo' as (generation << 1 | foreground), so pixels shared by neighborhoods are only
+ * converted once. 'generation' is advanced per call, which invalidates the memo of the
+ * previous frame without clearing it.
+ *
+ * Only the given pixels of the mask are written, the caller keeps the others 0.
+ */
+void Foreground::subtractHSVSparse(const Mat &bgr_image, const Mat &bg_hsv_image, const Mat &bg_deviation_image,
+		int h_threshold, int s_threshold, int v_threshold, const vector<int> &pixels, vector<unsigned int> &memo,
+		unsigned int &generation, Mat &foreground)
+{
+	assert(bgr_image.type() == CV_8UC3 && bg_hsv_image.type() == CV_8UC3 && bg_deviation_image.type() == CV_8UC3);
+	assert(bgr_image.size() == bg_hsv_image.size() && bgr_image.size() == bg_deviation_image.size());
+	assert(bgr_image.isContinuous() && bg_hsv_image.isContinuous() && bg_deviation_image.isContinuous());
+
+	const int cols = bgr_image.cols;
+	const int rows = bgr_image.rows;
+	foreground.create(bgr_image.size(), CV_8U);
+	assert(foreground.isContinuous());
+
+	// Generation 0 marks a never computed entry, restart when running out of generations
+	if (memo.size() != bgr_image.total() || ++generation >= (1u << 31))
+	{
+		memo.assign(bgr_image.total(), 0);
+		generation = 1;
+	}
+	const unsigned int computed = generation << 1;
+
+	const uchar* bgr = bgr_image.ptr<uchar>();
+	const uchar* bg_hsv = bg_hsv_image.ptr<uchar>();
+	const uchar* bg_deviation = bg_deviation_image.ptr<uchar>();
+	uchar* mask = foreground.ptr<uchar>();
+	uchar hsv[3];
+
+	for (size_t i = 0; i < pixels.size(); ++i)
+	{
+		const int offset = pixels[i];
+		const int y = offset / cols;
+		const int x = offset % cols;
+
+		int votes = 0, tested = 0;
+		for (int ny = max(0, y - 1); ny <= min(rows - 1, y + 1); ++ny)
+		{
+			for (int nx = max(0, x - 1); nx <= min(cols - 1, x + 1); ++nx)
+			{
+				const int n = ny * cols + nx;
+				if ((memo[n] & ~1u) != computed)
+					memo[n] = computed
+							| (unsigned int) subtractPixel(bgr + 3 * n, bg_hsv + 3 * n, bg_deviation + 3 * n, hsv,
+									h_threshold, s_threshold, v_threshold);
+				votes += memo[n] & 1;
+				++tested;
+			}
+		}
+
+		mask[offset] = 2 * votes > tested ? 255 : 0;
+	}
+}
+
+} /* namespace nl_uu_science_gmt */
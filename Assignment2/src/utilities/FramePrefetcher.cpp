@@ -0,0 +1,184 @@
+/*
+ * FramePrefetcher.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "FramePrefetcher.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "SeekIndex.h"
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+FramePrefetcher::FramePrefetcher() :
+		_index(NULL), _head(0), _tail(0), _seek(0), _stop(false), _epoch(0), _expected(0)
+{
+}
+
+FramePrefetcher::~FramePrefetcher()
+{
+	stop();
+}
+
+/**
+ * Start decoding 'video' from frame 0 ahead into a ring of 'slots' frames, seeking with
+ * 'index' if given. The video is only used by the decode thread from now on.
+ */
+void FramePrefetcher::start(const VideoCapture &video, size_t slots, const SeekIndex* index)
+{
+	stop();
+
+	_video = video;
+	_index = index != NULL && !index->isEmpty() ? index : NULL;
+	_expected = -1;  // the first read positions the video
+	if (slots == 0) return;
+
+	_slots.assign(slots, Slot());
+	_head.store(0);
+	_tail.store(0);
+	_seek.store(packSeek(0, 0));
+	_stop.store(false);
+	_epoch = 0;
+	_expected = 0;
+	position(0);
+
+	_thread = thread(&FramePrefetcher::decode, this);
+}
+
+/**
+ * Stop and join the decode thread
+ */
+void FramePrefetcher::stop()
+{
+	if (!_thread.joinable()) return;
+	_stop.store(true);
+	_thread.join();
+}
+
+/**
+ * Make frame 'number' the next frame the video reads
+ */
+void FramePrefetcher::position(long number)
+{
+	if (_index != NULL)
+		_index->seek(_video, (int) number);
+	else
+		_video.set(CV_CAP_PROP_POS_FRAMES, number);
+}
+
+/**
+ * The decode thread: fill the ring, following the seeks of the consumer
+ */
+void FramePrefetcher::decode()
+{
+	uint64_t seek = _seek.load(memory_order_acquire);
+	uint32_t epoch = (uint32_t) (seek >> 32);
+	long number = (long) (uint32_t) seek;
+	bool ended = false;
+
+	while (!_stop.load(memory_order_relaxed))
+	{
+		// Reposition on a new seek (the consumer drops whatever was queued before it)
+		const uint64_t latest = _seek.load(memory_order_acquire);
+		if (latest != seek)
+		{
+			seek = latest;
+			epoch = (uint32_t) (seek >> 32);
+			number = (long) (uint32_t) seek;
+			position(number);
+			ended = false;
+		}
+
+		// Backpressure: wait for the consumer while the ring is full or the video has ended
+		const size_t tail = _tail.load(memory_order_relaxed);
+		if (ended || tail - _head.load(memory_order_acquire) == _slots.size())
+		{
+			this_thread::sleep_for(chrono::microseconds(500));
+			continue;
+		}
+
+		Slot &slot = _slots[tail % _slots.size()];
+		_video >> slot.frame;
+		slot.number = number++;
+		slot.epoch = epoch;
+		ended = slot.frame.empty();
+		_tail.store(tail + 1, memory_order_release);
+	}
+}
+
+/**
+ * Whether frame 'number' is better reached by decoding on from the next frame than by a
+ * seek: it's ahead, and a seek wouldn't start decoding beyond the next frame (without a
+ * seek index: it's at most a ring's worth of frames ahead)
+ */
+bool FramePrefetcher::isAhead(long number) const
+{
+	if (_expected < 0 || number <= _expected) return false;
+	if (_index != NULL) return _index->getSeekPoint((int) number) <= _expected;
+	return number - _expected <= (long) max<size_t>(_slots.size(), 1);
+}
+
+/**
+ * Read frame 'number' into 'frame': from the ring if it was decoded ahead, otherwise after
+ * seeking to it. A frame a little ahead (see isAhead, eg. when a live consumer drops frames)
+ * is decoded on to instead, which is cheaper than seeking to the keyframe before it.
+ * False (and an empty frame) beyond the end of the video.
+ */
+bool FramePrefetcher::read(long number, Mat &frame)
+{
+	if (!_thread.joinable())
+	{
+		if (isAhead(number))
+		{
+			for (; _expected < number; ++_expected)
+				if (!_video.grab()) break;
+		}
+		else if (number != _expected)
+		{
+			position(number);
+		}
+		_video >> frame;
+		_expected = frame.empty() ? -1 : number + 1;
+		return !frame.empty();
+	}
+
+	if (number != _expected && !isAhead(number))
+	{
+		_seek.store(packSeek(++_epoch, number), memory_order_release);
+		_expected = number;
+	}
+
+	for (;;)
+	{
+		const size_t head = _head.load(memory_order_relaxed);
+		if (_tail.load(memory_order_acquire) == head)
+		{
+			this_thread::yield();
+			continue;
+		}
+
+		// Frames of an earlier seek are dropped, within a seek they're consecutive, so the ones
+		// before 'number' are dropped as well (when decoding on to a frame ahead). The end of
+		// the video (an empty frame) may come before 'number'.
+		Slot &slot = _slots[head % _slots.size()];
+		const bool match = slot.epoch == _epoch && (slot.number == number || slot.frame.empty());
+		if (match) slot.frame.copyTo(frame);
+		_head.store(head + 1, memory_order_release);
+
+		if (match)
+		{
+			// Past the end the producer waits, so whatever is read next needs a seek
+			_expected = frame.empty() ? -1 : number + 1;
+			return !frame.empty();
+		}
+	}
+}
+
+} /* namespace nl_uu_science_gmt */
@@ -0,0 +1,260 @@
+/*
+ * FrameStore.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "FrameStore.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "ColorSpace.h"
+#include "General.h"
+#include "SeekIndex.h"
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+const uint32_t FrameStore::MAGIC = 0x54535246;  // "FRST"
+const int32_t FrameStore::VERSION = 2;  // 2: modification time
+const size_t FrameStore::HEADER_BYTES = 4096;
+
+FrameStore::FrameStore() :
+		_data(NULL), _bytes(0),
+#ifdef _WIN32
+		_file(INVALID_HANDLE_VALUE), _mapping(NULL),
+#else
+		_file(-1),
+#endif
+		_frames(0), _format(BGR), _frame_stride(0)
+{
+}
+
+FrameStore::~FrameStore()
+{
+	close();
+}
+
+/**
+ * Decode the video 'video_path' once into the store 'store_path' in the given format,
+ * unless that store is already there and belongs to this video
+ */
+bool FrameStore::transcode(const string &video_path, const string &store_path, Format format)
+{
+	const int64_t video_bytes = General::fsize(video_path);
+	const int64_t video_time = General::fmtime(video_path);
+	if (video_bytes <= 0) return false;
+	if (isCurrent(store_path, video_path, format)) return true;
+
+	VideoCapture video(video_path);
+	if (!video.isOpened()) return false;
+
+	ofstream file(store_path.c_str(), ios::binary);
+	if (!file.is_open())
+	{
+		cout << "Unable to write: " << store_path << endl;
+		return false;
+	}
+
+	cout << "Transcoding " << video_path << "..." << flush;
+	Mat frame, hsv;
+	Size size;
+	size_t stride = 0;
+	int32_t frames = 0;
+	vector<char> padding;
+	const vector<char> header(HEADER_BYTES, 0);
+
+	while (video.read(frame) && !frame.empty())
+	{
+		if (frames == 0)
+		{
+			// The header is written (again) with the frame count at the end, an interrupted
+			// transcode leaves a store of 0 frames
+			size = frame.size();
+			const size_t frame_bytes = (size_t) size.area() * 3 * format;
+			stride = (frame_bytes + 63) & ~(size_t) 63;
+			padding.assign(stride - frame_bytes, 0);
+			file.write(&header[0], header.size());
+		}
+		if (frame.size() != size || frame.type() != CV_8UC3) break;
+
+		for (int y = 0; y < size.height; ++y)
+			file.write((const char*) frame.ptr<uchar>(y), size.width * 3);
+		if (format == BGR_HSV)
+		{
+			ColorSpace::bgrToHsv(frame, hsv);
+			for (int y = 0; y < size.height; ++y)
+				file.write((const char*) hsv.ptr<uchar>(y), size.width * 3);
+		}
+		if (!padding.empty()) file.write(&padding[0], padding.size());
+		++frames;
+	}
+	if (frames == 0)
+	{
+		cout << " failed!" << endl;
+		file.close();
+		remove(store_path.c_str());
+		return false;
+	}
+
+	const int32_t width = size.width, height = size.height, format32 = format;
+	const int64_t stride64 = (int64_t) stride;
+	file.seekp(0);
+	file.write((const char*) &MAGIC, sizeof(MAGIC));
+	file.write((const char*) &VERSION, sizeof(VERSION));
+	file.write((const char*) &video_bytes, sizeof(video_bytes));
+	file.write((const char*) &video_time, sizeof(video_time));
+	file.write((const char*) &frames, sizeof(frames));
+	file.write((const char*) &width, sizeof(width));
+	file.write((const char*) &height, sizeof(height));
+	file.write((const char*) &format32, sizeof(format32));
+	file.write((const char*) &stride64, sizeof(stride64));
+	if (!file)
+	{
+		cout << " unable to write: " << store_path << endl;
+		return false;
+	}
+	cout << " " << frames << " frames" << endl;
+	return true;
+}
+
+/**
+ * Read and check a store's header
+ */
+bool FrameStore::readHeader(istream &file, int64_t &source_bytes, int64_t &source_time, int &frames, Size &size,
+		Format &format, size_t &stride)
+{
+	uint32_t magic = 0;
+	int32_t version = 0, frames32 = 0, width = 0, height = 0, format32 = 0;
+	int64_t stride64 = 0;
+	file.read((char*) &magic, sizeof(magic));
+	file.read((char*) &version, sizeof(version));
+	file.read((char*) &source_bytes, sizeof(source_bytes));
+	file.read((char*) &source_time, sizeof(source_time));
+	file.read((char*) &frames32, sizeof(frames32));
+	file.read((char*) &width, sizeof(width));
+	file.read((char*) &height, sizeof(height));
+	file.read((char*) &format32, sizeof(format32));
+	file.read((char*) &stride64, sizeof(stride64));
+	if (!file || magic != MAGIC || version != VERSION || frames32 <= 0 || width <= 0 || height <= 0
+			|| (format32 != BGR && format32 != BGR_HSV) || stride64 < (int64_t) width * height * 3 * format32)
+		return false;
+
+	frames = frames32;
+	size = Size(width, height);
+	format = (Format) format32;
+	stride = (size_t) stride64;
+	return true;
+}
+
+/**
+ * Whether the store 'store_path' holds all frames of the video 'video_path' in the given format
+ */
+bool FrameStore::isCurrent(const string &store_path, const string &video_path, Format format)
+{
+	FrameStore store;
+	return store.open(store_path, video_path) && store.getFormat() == format;
+}
+
+/**
+ * Map the store 'store_path', if it was made from the video 'video_path': a video of the same
+ * size in bytes, last modified at the same time, that still starts with the same frame
+ */
+bool FrameStore::open(const string &store_path, const string &video_path)
+{
+	close();
+
+	const int64_t video_bytes = General::fsize(video_path);
+	const int64_t video_time = General::fmtime(video_path);
+	ifstream header(store_path.c_str(), ios::binary);
+	int64_t source_bytes = 0, source_time = 0;
+	if (video_bytes <= 0 || !header.is_open()
+			|| !readHeader(header, source_bytes, source_time, _frames, _size, _format, _frame_stride)
+			|| source_bytes != video_bytes || source_time != video_time) return false;
+	header.close();
+
+	_bytes = HEADER_BYTES + (size_t) _frames * _frame_stride;
+	if (General::fsize(store_path) < (int64_t) _bytes) return false;
+
+#ifdef _WIN32
+	_file = CreateFileA(store_path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL, NULL);
+	if (_file == INVALID_HANDLE_VALUE) return false;
+	_mapping = CreateFileMappingA(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (_mapping != NULL) _data = (const uchar*) MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, _bytes);
+#else
+	_file = ::open(store_path.c_str(), O_RDONLY);
+	if (_file < 0) return false;
+	void* data = mmap(NULL, _bytes, PROT_READ, MAP_SHARED, _file, 0);
+	if (data != MAP_FAILED) _data = (const uchar*) data;
+#endif
+	if (_data == NULL)
+	{
+		close();
+		return false;
+	}
+
+	// A video re-encoded to the same size within the same second still differs in its first frame
+	VideoCapture video(video_path);
+	Mat first;
+	if (!video.read(first) || first.empty() || first.size() != _size
+			|| SeekIndex::hashFrame(first) != SeekIndex::hashFrame(frame(0)))
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Unmap the store, the headers frame() returned are invalid from now on
+ */
+void FrameStore::close()
+{
+#ifdef _WIN32
+	if (_data != NULL) UnmapViewOfFile(_data);
+	if (_mapping != NULL) CloseHandle(_mapping);
+	if (_file != INVALID_HANDLE_VALUE) CloseHandle(_file);
+	_mapping = NULL;
+	_file = INVALID_HANDLE_VALUE;
+#else
+	if (_data != NULL) munmap((void*) _data, _bytes);
+	if (_file >= 0) ::close(_file);
+	_file = -1;
+#endif
+	_data = NULL;
+	_bytes = 0;
+	_frames = 0;
+}
+
+/**
+ * A (read-only) header over BGR frame 'number', empty beyond the stored frames
+ */
+Mat FrameStore::frame(int number) const
+{
+	if (_data == NULL || number < 0 || number >= _frames) return Mat();
+	return Mat(_size, CV_8UC3, (void*) (_data + HEADER_BYTES + (size_t) number * _frame_stride));
+}
+
+/**
+ * A (read-only) header over HSV frame 'number', empty beyond the stored frames or if the
+ * store doesn't hold HSV frames
+ */
+Mat FrameStore::hsvFrame(int number) const
+{
+	if (_data == NULL || _format != BGR_HSV || number < 0 || number >= _frames) return Mat();
+	return Mat(_size, CV_8UC3, (void*) (_data + HEADER_BYTES + (size_t) number * _frame_stride + _size.area() * 3));
+}
+
+} /* namespace nl_uu_science_gmt */
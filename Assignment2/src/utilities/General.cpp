@@ -7,8 +7,46 @@
 
 #include "General.h"
 
+#include <sys/stat.h>
+
+#ifdef DEBUG
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#endif
+
 using namespace std;
 
+#ifdef DEBUG
+// Debug builds count every heap allocation made through operator new, so the steady state of the
+// frame loop can be checked to be allocation free (cv::Mat storage comes from cv::fastMalloc instead,
+// see Camera::Workspace::track() for that)
+static std::atomic<size_t> Allocations(0);
+
+void* operator new(size_t size)
+{
+	++Allocations;
+	void* memory = malloc(size > 0 ? size : 1);
+	if (memory == NULL) throw bad_alloc();
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* memory) throw()
+{
+	free(memory);
+}
+
+void operator delete[](void* memory) throw()
+{
+	free(memory);
+}
+#endif
+
 namespace nl_uu_science_gmt
 {
 
@@ -17,6 +55,10 @@ const string General::CalibrationVideo		= "calibration.avi";
 const string General::CheckerboadVideo		= "checkerboard.avi";
 const string General::BackgroundVideoFile	= "background.avi";
 const string General::BackgroundImageFile	= "background.png";
+const string General::BackgroundStatsFile	= "background_stats.bin";
+const string General::SeekIndexFile			= "video_seek.bin";
+const string General::VideoInfoFile			= "video_info.bin";
+const string General::FrameStoreFile			= "video_frames.bin";
 const string General::VideoFile				= "video.avi";
 const string General::IntrinsicsFile		= "intrinsics.xml";
 const string General::CheckerboadCorners	= "boardcorners.xml";
@@ -31,4 +73,34 @@ bool General::fexists(const std::string &filename)
 	return ifile.is_open();
 }
 
+/**
+ * Size of a file in bytes, -1 if it can't be opened
+ */
+int64_t General::fsize(const std::string &filename)
+{
+	ifstream ifile(filename.c_str(), ios::binary | ios::ate);
+	if (!ifile.is_open()) return -1;
+	return (int64_t) ifile.tellg();
+}
+
+/**
+ * Last modification time of a file (seconds since the epoch), -1 if it doesn't exist
+ */
+int64_t General::fmtime(const std::string &filename)
+{
+	struct stat status;
+	if (stat(filename.c_str(), &status) != 0) return -1;
+	return (int64_t) status.st_mtime;
+}
+
+#ifdef DEBUG
+/**
+ * Amount of heap allocations made through operator new so far
+ */
+size_t General::getAllocations()
+{
+	return Allocations;
+}
+#endif
+
 } /* namespace nl_uu_science_gmt */
@@ -0,0 +1,533 @@
+/*
+ * GraphCut.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "GraphCut.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+// Data terms are in [0, 2 * DATA_NEUTRAL], DATA_NEUTRAL means a difference equal to the threshold
+static const int DATA_NEUTRAL = 16;
+// Value difference between neighbours at which the smoothness term has dropped to ~60%
+static const double CONTRAST_SIGMA = 16.0;
+
+const int GraphCut::FREE;
+const int GraphCut::TERMINAL;
+const int GraphCut::ORPHAN;
+
+GraphCut::GraphCut() :
+		_active_first(0), _time(0), _flow(0), _smoothness(-1)
+{
+}
+
+/**
+ * Refine the thresholded foreground mask within `band` pixels of its boundary
+ *
+ * @param mask         thresholded 0/255 foreground mask
+ * @param hsv_image    the frame in HSV-color space
+ * @param bg_hsv_image the background in HSV-color space
+ * @param band         half width of the band around the silhouette boundary
+ * @param smoothness   weight of the smoothness terms, relative to data terms in [0, 32]
+ * @param foreground   the refined 0/255 mask (may be the same as mask)
+ */
+void GraphCut::segment(const Mat &mask, const Mat &hsv_image, const Mat &bg_hsv_image, int h_threshold,
+		int s_threshold, int v_threshold, int band, int smoothness, Mat &foreground)
+{
+	assert(mask.type() == CV_8U && hsv_image.type() == CV_8UC3 && bg_hsv_image.type() == CV_8UC3);
+	assert(mask.size() == hsv_image.size() && mask.size() == bg_hsv_image.size());
+
+	if (smoothness != _smoothness)
+	{
+		_smoothness = smoothness;
+		_smoothness_lut.resize(256);
+		for (int d = 0; d < 256; ++d)
+			_smoothness_lut[d] = (Capacity) cvRound(smoothness * exp(-(d * d) / (2 * CONTRAST_SIGMA * CONTRAST_SIGMA)));
+	}
+
+	// The band: inside the dilated, but outside the eroded silhouette
+	_morphology.dilate(mask, _outer, max(1, band));
+	_morphology.erode(mask, _inner, max(1, band));
+
+	clear();
+	_node_index.create(mask.size(), CV_32S);
+	for (int y = 0; y < mask.rows; ++y)
+	{
+		const uchar* outer = _outer.ptr<uchar>(y);
+		const uchar* inner = _inner.ptr<uchar>(y);
+		int* index = _node_index.ptr<int>(y);
+		for (int x = 0; x < mask.cols; ++x)
+			index[x] = outer[x] != inner[x] ? addNode() : -1;
+	}
+
+	const int rows = mask.rows, cols = mask.cols;
+	for (int y = 0; y < rows; ++y)
+	{
+		const int* index = _node_index.ptr<int>(y);
+		const uchar* hsv = hsv_image.ptr<uchar>(y);
+		const uchar* bg_hsv = bg_hsv_image.ptr<uchar>(y);
+
+		for (int x = 0; x < cols; ++x)
+		{
+			const int node = index[x];
+			if (node < 0) continue;
+
+			// Data term, a soft version of (H AND S) OR V: neutral at the thresholds
+			const uchar* p = hsv + 3 * x;
+			const uchar* b = bg_hsv + 3 * x;
+			const int h = min(2 * DATA_NEUTRAL, (abs(p[0] - b[0]) + 1) * DATA_NEUTRAL / (h_threshold + 1));
+			const int s = min(2 * DATA_NEUTRAL, (abs(p[1] - b[1]) + 1) * DATA_NEUTRAL / (s_threshold + 1));
+			const int v = min(2 * DATA_NEUTRAL, (abs(p[2] - b[2]) + 1) * DATA_NEUTRAL / (v_threshold + 1));
+			Capacity to_source = max(min(h, s), v);
+			Capacity to_sink = 2 * DATA_NEUTRAL - to_source;
+
+			// Smoothness terms with the 4 neighbours, the pixels outside the band are fixed
+			const int dx[] = { 1, 0, -1, 0 };
+			const int dy[] = { 0, 1, 0, -1 };
+			for (int n = 0; n < 4; ++n)
+			{
+				const int nx = x + dx[n], ny = y + dy[n];
+				if (nx < 0 || nx >= cols || ny < 0 || ny >= rows) continue;
+
+				const Capacity weight = _smoothness_lut[abs(p[2] - hsv_image.ptr<uchar>(ny)[3 * nx + 2])];
+				const int neighbour = _node_index.ptr<int>(ny)[nx];
+				if (neighbour >= 0)
+				{
+					// Every band pair once, from the right and lower neighbour
+					if (n < 2) addEdge(node, neighbour, weight, weight);
+				}
+				else if (mask.ptr<uchar>(ny)[nx])
+				{
+					to_source += weight;
+				}
+				else
+				{
+					to_sink += weight;
+				}
+			}
+
+			addTerminalWeights(node, to_source, to_sink);
+		}
+	}
+
+	maxflow();
+
+	if (&foreground != &mask) mask.copyTo(foreground);
+	for (int y = 0; y < rows; ++y)
+	{
+		const int* index = _node_index.ptr<int>(y);
+		uchar* out = foreground.ptr<uchar>(y);
+		for (int x = 0; x < cols; ++x)
+			if (index[x] >= 0) out[x] = isSource(index[x]) ? 255 : 0;
+	}
+}
+
+/**
+ * Remove all nodes and arcs, but keep their memory
+ */
+void GraphCut::clear()
+{
+	_nodes.clear();
+	_arcs.clear();
+	_active.clear();
+	_active_first = 0;
+	_orphans.clear();
+	_time = 0;
+	_flow = 0;
+}
+
+int GraphCut::addNode()
+{
+	Node node;
+	node.first = -1;
+	node.parent = FREE;
+	node.time = 0;
+	node.distance = 0;
+	node.sink = false;
+	node.active = false;
+	node.terminal = 0;
+	_nodes.push_back(node);
+	return (int) _nodes.size() - 1;
+}
+
+/**
+ * Add capacities from the source and to the sink, only their difference needs to be kept
+ */
+void GraphCut::addTerminalWeights(int i, Capacity source, Capacity sink)
+{
+	const Capacity delta = _nodes[i].terminal;
+	if (delta > 0)
+		source += delta;
+	else
+		sink -= delta;
+	_flow += min(source, sink);
+	_nodes[i].terminal = source - sink;
+}
+
+void GraphCut::addEdge(int i, int j, Capacity capacity, Capacity reverse_capacity)
+{
+	const int a = (int) _arcs.size();
+	Arc forward = { j, _nodes[i].first, capacity };
+	Arc reverse = { i, _nodes[j].first, reverse_capacity };
+	_arcs.push_back(forward);
+	_arcs.push_back(reverse);
+	_nodes[i].first = a;
+	_nodes[j].first = a + 1;
+}
+
+/**
+ * After maxflow(): whether node i is on the source (foreground) side of the minimum cut
+ */
+bool GraphCut::isSource(int i) const
+{
+	return _nodes[i].parent != FREE && !_nodes[i].sink;
+}
+
+void GraphCut::setActive(int i)
+{
+	if (_nodes[i].active) return;
+	_nodes[i].active = true;
+	_active.push_back(i);
+}
+
+/**
+ * Next active node that is still in a tree, or -1 when there are none left
+ */
+int GraphCut::nextActive()
+{
+	while (_active_first < _active.size())
+	{
+		const int i = _active[_active_first++];
+		_nodes[i].active = false;
+		if (_nodes[i].parent != FREE) return i;
+	}
+
+	_active.clear();
+	_active_first = 0;
+	return -1;
+}
+
+void GraphCut::setOrphan(int i)
+{
+	_nodes[i].parent = ORPHAN;
+	_orphans.push_back(i);
+}
+
+/**
+ * Push the bottleneck capacity along the path through the given source to sink tree arc
+ */
+void GraphCut::augment(int middle)
+{
+	// Find the bottleneck
+	Capacity bottleneck = _arcs[middle].residual;
+	int i, a;
+	for (i = _arcs[middle ^ 1].head; (a = _nodes[i].parent) != TERMINAL; i = _arcs[a].head)
+		bottleneck = min(bottleneck, _arcs[a ^ 1].residual);
+	bottleneck = min(bottleneck, _nodes[i].terminal);
+	for (i = _arcs[middle].head; (a = _nodes[i].parent) != TERMINAL; i = _arcs[a].head)
+		bottleneck = min(bottleneck, _arcs[a].residual);
+	bottleneck = min(bottleneck, -_nodes[i].terminal);
+
+	// Augment, the nodes whose arc to their parent saturates become orphans
+	_arcs[middle ^ 1].residual += bottleneck;
+	_arcs[middle].residual -= bottleneck;
+	for (i = _arcs[middle ^ 1].head;; i = _arcs[a].head)
+	{
+		a = _nodes[i].parent;
+		if (a == TERMINAL)
+		{
+			_nodes[i].terminal -= bottleneck;
+			if (_nodes[i].terminal == 0) setOrphan(i);
+			break;
+		}
+		_arcs[a].residual += bottleneck;
+		_arcs[a ^ 1].residual -= bottleneck;
+		if (_arcs[a ^ 1].residual == 0) setOrphan(i);
+	}
+	for (i = _arcs[middle].head;; i = _arcs[a].head)
+	{
+		a = _nodes[i].parent;
+		if (a == TERMINAL)
+		{
+			_nodes[i].terminal += bottleneck;
+			if (_nodes[i].terminal == 0) setOrphan(i);
+			break;
+		}
+		_arcs[a ^ 1].residual += bottleneck;
+		_arcs[a].residual -= bottleneck;
+		if (_arcs[a].residual == 0) setOrphan(i);
+	}
+
+	_flow += bottleneck;
+}
+
+/**
+ * Find a new parent in the source tree for orphan i, or free it and orphan its children
+ */
+void GraphCut::adoptSourceOrphan(int i)
+{
+	const int infinite = numeric_limits<int>::max();
+	int best_arc = FREE, best_distance = infinite;
+
+	for (int a0 = _nodes[i].first; a0 >= 0; a0 = _arcs[a0].next)
+	{
+		if (_arcs[a0 ^ 1].residual == 0) continue;
+		int j = _arcs[a0].head;
+		if (_nodes[j].sink || _nodes[j].parent == FREE) continue;
+
+		// Check that j originates from the source, and how far
+		int distance = 0;
+		for (;;)
+		{
+			if (_nodes[j].time == _time)
+			{
+				distance += _nodes[j].distance;
+				break;
+			}
+			const int a = _nodes[j].parent;
+			++distance;
+			if (a == TERMINAL)
+			{
+				_nodes[j].time = _time;
+				_nodes[j].distance = 1;
+				break;
+			}
+			if (a == ORPHAN)
+			{
+				distance = infinite;
+				break;
+			}
+			j = _arcs[a].head;
+		}
+
+		if (distance < infinite)
+		{
+			if (distance < best_distance)
+			{
+				best_arc = a0;
+				best_distance = distance;
+			}
+			// Mark the distances along the path
+			for (j = _arcs[a0].head; _nodes[j].time != _time; j = _arcs[_nodes[j].parent].head)
+			{
+				_nodes[j].time = _time;
+				_nodes[j].distance = distance--;
+			}
+		}
+	}
+
+	_nodes[i].parent = best_arc;
+	if (best_arc != FREE)
+	{
+		_nodes[i].time = _time;
+		_nodes[i].distance = best_distance + 1;
+		return;
+	}
+
+	// No parent found: the neighbours may grow into i again, its children become orphans
+	for (int a0 = _nodes[i].first; a0 >= 0; a0 = _arcs[a0].next)
+	{
+		const int j = _arcs[a0].head;
+		const int a = _nodes[j].parent;
+		if (_nodes[j].sink || a == FREE) continue;
+
+		if (_arcs[a0 ^ 1].residual) setActive(j);
+		if (a != TERMINAL && a != ORPHAN && _arcs[a].head == i) setOrphan(j);
+	}
+}
+
+/**
+ * Find a new parent in the sink tree for orphan i, or free it and orphan its children
+ */
+void GraphCut::adoptSinkOrphan(int i)
+{
+	const int infinite = numeric_limits<int>::max();
+	int best_arc = FREE, best_distance = infinite;
+
+	for (int a0 = _nodes[i].first; a0 >= 0; a0 = _arcs[a0].next)
+	{
+		if (_arcs[a0].residual == 0) continue;
+		int j = _arcs[a0].head;
+		if (!_nodes[j].sink || _nodes[j].parent == FREE) continue;
+
+		// Check that j originates from the sink, and how far
+		int distance = 0;
+		for (;;)
+		{
+			if (_nodes[j].time == _time)
+			{
+				distance += _nodes[j].distance;
+				break;
+			}
+			const int a = _nodes[j].parent;
+			++distance;
+			if (a == TERMINAL)
+			{
+				_nodes[j].time = _time;
+				_nodes[j].distance = 1;
+				break;
+			}
+			if (a == ORPHAN)
+			{
+				distance = infinite;
+				break;
+			}
+			j = _arcs[a].head;
+		}
+
+		if (distance < infinite)
+		{
+			if (distance < best_distance)
+			{
+				best_arc = a0;
+				best_distance = distance;
+			}
+			// Mark the distances along the path
+			for (j = _arcs[a0].head; _nodes[j].time != _time; j = _arcs[_nodes[j].parent].head)
+			{
+				_nodes[j].time = _time;
+				_nodes[j].distance = distance--;
+			}
+		}
+	}
+
+	_nodes[i].parent = best_arc;
+	if (best_arc != FREE)
+	{
+		_nodes[i].time = _time;
+		_nodes[i].distance = best_distance + 1;
+		return;
+	}
+
+	// No parent found: the neighbours may grow into i again, its children become orphans
+	for (int a0 = _nodes[i].first; a0 >= 0; a0 = _arcs[a0].next)
+	{
+		const int j = _arcs[a0].head;
+		const int a = _nodes[j].parent;
+		if (!_nodes[j].sink || a == FREE) continue;
+
+		if (_arcs[a0].residual) setActive(j);
+		if (a != TERMINAL && a != ORPHAN && _arcs[a].head == i) setOrphan(j);
+	}
+}
+
+/**
+ * Boykov-Kolmogorov maximum flow: grow a search tree from both terminals, augment
+ * along the path where they touch and repair the trees by adopting the orphans
+ */
+GraphCut::Capacity GraphCut::maxflow()
+{
+	for (int i = 0; i < (int) _nodes.size(); ++i)
+	{
+		Node &node = _nodes[i];
+		if (node.terminal == 0) continue;
+		node.sink = node.terminal < 0;
+		node.parent = TERMINAL;
+		node.time = 0;
+		node.distance = 1;
+		setActive(i);
+	}
+
+	int current = -1;
+	for (;;)
+	{
+		// Grow the trees from the current or next active node
+		int i = current;
+		if (i < 0 || _nodes[i].parent == FREE)
+		{
+			i = nextActive();
+			if (i < 0) break;
+		}
+
+		int middle = -1;
+		if (!_nodes[i].sink)
+		{
+			for (int a = _nodes[i].first; a >= 0; a = _arcs[a].next)
+			{
+				if (_arcs[a].residual == 0) continue;
+				const int j = _arcs[a].head;
+				if (_nodes[j].parent == FREE)
+				{
+					_nodes[j].sink = false;
+					_nodes[j].parent = a ^ 1;
+					_nodes[j].time = _nodes[i].time;
+					_nodes[j].distance = _nodes[i].distance + 1;
+					setActive(j);
+				}
+				else if (_nodes[j].sink)
+				{
+					middle = a;
+					break;
+				}
+				else if (_nodes[j].time <= _nodes[i].time && _nodes[j].distance > _nodes[i].distance)
+				{
+					// Shorter path to the terminal
+					_nodes[j].parent = a ^ 1;
+					_nodes[j].time = _nodes[i].time;
+					_nodes[j].distance = _nodes[i].distance + 1;
+				}
+			}
+		}
+		else
+		{
+			for (int a = _nodes[i].first; a >= 0; a = _arcs[a].next)
+			{
+				if (_arcs[a ^ 1].residual == 0) continue;
+				const int j = _arcs[a].head;
+				if (_nodes[j].parent == FREE)
+				{
+					_nodes[j].sink = true;
+					_nodes[j].parent = a ^ 1;
+					_nodes[j].time = _nodes[i].time;
+					_nodes[j].distance = _nodes[i].distance + 1;
+					setActive(j);
+				}
+				else if (!_nodes[j].sink)
+				{
+					middle = a ^ 1;
+					break;
+				}
+				else if (_nodes[j].time <= _nodes[i].time && _nodes[j].distance > _nodes[i].distance)
+				{
+					// Shorter path to the terminal
+					_nodes[j].parent = a ^ 1;
+					_nodes[j].time = _nodes[i].time;
+					_nodes[j].distance = _nodes[i].distance + 1;
+				}
+			}
+		}
+
+		++_time;
+		if (middle < 0)
+		{
+			current = -1;
+			continue;
+		}
+
+		// Keep growing from this node after the augmentation
+		current = i;
+		augment(middle);
+
+		while (!_orphans.empty())
+		{
+			const int orphan = _orphans.back();
+			_orphans.pop_back();
+			if (_nodes[orphan].sink)
+				adoptSinkOrphan(orphan);
+			else
+				adoptSourceOrphan(orphan);
+		}
+	}
+
+	return _flow;
+}
+
+} /* namespace nl_uu_science_gmt */
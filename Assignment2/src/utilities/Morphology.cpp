@@ -0,0 +1,225 @@
+/*
+ * Morphology.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "Morphology.h"
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+// The masks are binary, so the running minimum/maximum is a bitwise AND/OR
+struct AndOp
+{
+	template<typename T> T operator()(T a, T b) const
+	{
+		return a & b;
+	}
+};
+
+struct OrOp
+{
+	template<typename T> T operator()(T a, T b) const
+	{
+		return a | b;
+	}
+};
+
+/**
+ * van Herk/Gil-Werman running extremum over a window of 2 * radius + 1 elements
+ *
+ * Filters `length` elements (with the given stride) of `n` parallel lines at once,
+ * elements outside [0, length) have the border value. The padded line is cut in
+ * blocks of the window size, forward holds the extremum from the block start up to
+ * an element and backward from an element up to the block end; every window spans
+ * at most two blocks, so it's the extremum of one backward and one forward value.
+ */
+template<typename T, typename OP>
+void Morphology::vanHerk(const T* src, size_t src_stride, T* dst, size_t dst_stride, int length, int n, int radius,
+		T border, vector<T> &forward, vector<T> &backward)
+{
+	const OP op = OP();
+	const int window = 2 * radius + 1;
+	const int padded = ((length + 2 * radius + window - 1) / window) * window;
+	forward.resize((size_t) padded * n);
+	backward.resize((size_t) padded * n);
+
+	for (int i = 0; i < padded; ++i)
+	{
+		const int e = i - radius;
+		const T* in = (e >= 0 && e < length) ? src + e * src_stride : NULL;
+		T* out = &forward[(size_t) i * n];
+		const bool start = i % window == 0;
+		const T* previous = start ? NULL : out - n;
+
+		for (int j = 0; j < n; ++j)
+		{
+			const T value = in != NULL ? in[j] : border;
+			out[j] = start ? value : op(previous[j], value);
+		}
+	}
+
+	for (int i = padded - 1; i >= 0; --i)
+	{
+		const int e = i - radius;
+		const T* in = (e >= 0 && e < length) ? src + e * src_stride : NULL;
+		T* out = &backward[(size_t) i * n];
+		const T* next = out + n;
+		const bool end = i % window == window - 1;
+
+		for (int j = 0; j < n; ++j)
+		{
+			const T value = in != NULL ? in[j] : border;
+			out[j] = end ? value : op(next[j], value);
+		}
+	}
+
+	// Element e is the window [e, e + 2 * radius] of the padded line
+	for (int e = 0; e < length; ++e)
+	{
+		const T* b = &backward[(size_t) e * n];
+		const T* f = &forward[(size_t) (e + 2 * radius) * n];
+		T* out = dst + e * dst_stride;
+		for (int j = 0; j < n; ++j)
+			out[j] = op(b[j], f[j]);
+	}
+}
+
+/**
+ * dst bit i becomes src bit i + shift, bits outside src take the fill value
+ */
+void Morphology::shiftBits(const uint64_t* src, int src_words, uint64_t* dst, int dst_words, int shift, uint64_t fill)
+{
+	const int bits = PackedMask::WORD_BITS;
+	const int words = shift >= 0 ? shift / bits : -((-shift + bits - 1) / bits);
+	const int remainder = shift - words * bits;
+
+	for (int i = 0; i < dst_words; ++i)
+	{
+		const int w = i + words;
+		const uint64_t low = (w >= 0 && w < src_words) ? src[w] : fill;
+		if (remainder == 0)
+		{
+			dst[i] = low;
+			continue;
+		}
+		const uint64_t high = (w + 1 >= 0 && w + 1 < src_words) ? src[w + 1] : fill;
+		dst[i] = (low >> remainder) | (high << (bits - remainder));
+	}
+}
+
+template<typename OP>
+void Morphology::filter(const Mat &src, Mat &dst, int radius, uchar border)
+{
+	assert(src.type() == CV_8U);
+	if (radius <= 0)
+	{
+		src.copyTo(dst);
+		return;
+	}
+
+	_horizontal.create(src.size(), CV_8U);
+	dst.create(src.size(), CV_8U);
+
+	// Rows one by one, then all columns at once so the inner loop runs along a row
+	for (int y = 0; y < src.rows; ++y)
+		vanHerk<uchar, OP>(src.ptr<uchar>(y), 1, _horizontal.ptr<uchar>(y), 1, src.cols, 1, radius, border, _forward,
+				_backward);
+	vanHerk<uchar, OP>(_horizontal.ptr<uchar>(), _horizontal.step1(), dst.ptr<uchar>(), dst.step1(), src.rows,
+			src.cols, radius, border, _forward, _backward);
+}
+
+template<typename OP>
+void Morphology::filter(const PackedMask &src, PackedMask &dst, int radius, uint64_t border)
+{
+	const OP op = OP();
+	const int words = src.getWordsPerRow();
+	const uint64_t last_word = src.getLastWordMask();
+	if (radius <= 0)
+	{
+		dst = src;
+		return;
+	}
+
+	_packed_horizontal.create(src.rows(), src.cols());
+	dst.create(src.rows(), src.cols());
+
+	// Horizontally: pad the row with radius border bits in front, then the AND/OR of
+	// `length` bits starting at each bit doubles per pass, up to the window size
+	const int window = 2 * radius + 1;
+	const int padded_words = (src.cols() + 2 * radius + PackedMask::WORD_BITS - 1) / PackedMask::WORD_BITS;
+	_span.resize(padded_words);
+	_shifted.resize(padded_words);
+
+	for (int y = 0; y < src.rows(); ++y)
+	{
+		// The bits beyond the last column are outside the image too
+		shiftBits(src.row(y), words, &_shifted[0], words, 0, border);
+		_shifted[words - 1] = (_shifted[words - 1] & last_word) | (border & ~last_word);
+		shiftBits(&_shifted[0], words, &_span[0], padded_words, -radius, border);
+
+		int length = 1;
+		for (; 2 * length <= window; length *= 2)
+		{
+			shiftBits(&_span[0], padded_words, &_shifted[0], padded_words, length, border);
+			for (int w = 0; w < padded_words; ++w)
+				_span[w] = op(_span[w], _shifted[w]);
+		}
+		if (length < window)
+		{
+			// Two overlapping spans cover the rest of the window
+			shiftBits(&_span[0], padded_words, &_shifted[0], padded_words, window - length, border);
+			for (int w = 0; w < padded_words; ++w)
+				_span[w] = op(_span[w], _shifted[w]);
+		}
+
+		uint64_t* out = _packed_horizontal.row(y);
+		for (int w = 0; w < words; ++w)
+			out[w] = _span[w];
+		out[words - 1] &= last_word;
+	}
+
+	// Vertically: the same running AND/OR as for 8-bit masks, 64 columns per word
+	vanHerk<uint64_t, OP>(_packed_horizontal.row(0), words, dst.row(0), words, src.rows(), words, radius, border,
+			_packed_forward, _packed_backward);
+	for (int y = 0; y < dst.rows(); ++y)
+		dst.row(y)[words - 1] &= last_word;
+}
+
+/**
+ * Erode a 0/255 mask with a (2 * radius + 1) square
+ */
+void Morphology::erode(const Mat &src, Mat &dst, int radius)
+{
+	filter<AndOp>(src, dst, radius, 255);
+}
+
+/**
+ * Dilate a 0/255 mask with a (2 * radius + 1) square
+ */
+void Morphology::dilate(const Mat &src, Mat &dst, int radius)
+{
+	filter<OrOp>(src, dst, radius, 0);
+}
+
+/**
+ * Erode a packed mask with a (2 * radius + 1) square
+ */
+void Morphology::erode(const PackedMask &src, PackedMask &dst, int radius)
+{
+	filter<AndOp>(src, dst, radius, ~(uint64_t) 0);
+}
+
+/**
+ * Dilate a packed mask with a (2 * radius + 1) square
+ */
+void Morphology::dilate(const PackedMask &src, PackedMask &dst, int radius)
+{
+	filter<OrOp>(src, dst, radius, 0);
+}
+
+} /* namespace nl_uu_science_gmt */
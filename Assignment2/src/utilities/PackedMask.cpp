@@ -0,0 +1,121 @@
+/*
+ * PackedMask.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "PackedMask.h"
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+const int PackedMask::WORD_BITS;
+
+PackedMask::PackedMask() :
+		_rows(0), _cols(0), _words_per_row(0)
+{
+}
+
+/**
+ * Size the mask, the word storage is only reallocated when it has to grow
+ */
+void PackedMask::create(int rows, int cols)
+{
+	_rows = rows;
+	_cols = cols;
+	_words_per_row = (cols + WORD_BITS - 1) / WORD_BITS;
+	_words.resize((size_t) _rows * _words_per_row);
+}
+
+/**
+ * Pack an 8-bit mask, every non-zero pixel sets its bit
+ */
+void PackedMask::pack(const Mat &mask)
+{
+	assert(mask.type() == CV_8U);
+	create(mask.rows, mask.cols);
+
+	for (int y = 0; y < _rows; ++y)
+	{
+		const uchar* pixels = mask.ptr<uchar>(y);
+		uint64_t* words = row(y);
+
+		for (int w = 0; w < _words_per_row; ++w)
+		{
+			const int x0 = w * WORD_BITS;
+			const int bits = min(WORD_BITS, _cols - x0);
+
+			uint64_t word = 0;
+			for (int b = 0; b < bits; ++b)
+				word |= (uint64_t) (pixels[x0 + b] != 0) << b;
+			words[w] = word;
+		}
+	}
+}
+
+/**
+ * Expand to an 8-bit mask of 0 and 255
+ */
+void PackedMask::unpack(Mat &mask) const
+{
+	mask.create(_rows, _cols, CV_8U);
+
+	for (int y = 0; y < _rows; ++y)
+	{
+		const uint64_t* words = row(y);
+		uchar* pixels = mask.ptr<uchar>(y);
+
+		for (int x = 0; x < _cols; ++x)
+			pixels[x] = (uchar) -(int) ((words[x / WORD_BITS] >> (x % WORD_BITS)) & 1);
+	}
+}
+
+/**
+ * Compute the per row popcount prefixes used by count()
+ */
+void PackedMask::summarize()
+{
+	const int stride = _words_per_row + 1;
+	_row_counts.resize((size_t) _rows * stride);
+
+	for (int y = 0; y < _rows; ++y)
+	{
+		const uint64_t* words = row(y);
+		int* counts = &_row_counts[(size_t) y * stride];
+
+		counts[0] = 0;
+		for (int w = 0; w < _words_per_row; ++w)
+			counts[w + 1] = counts[w] + popcount(words[w]);
+	}
+}
+
+/**
+ * The amount of set pixels within the rectangle, requires summarize() after the last change
+ */
+int PackedMask::count(const Rect &rect) const
+{
+	if (rect.width <= 0 || rect.height <= 0) return 0;
+
+	const int stride = _words_per_row + 1;
+	const int x0 = rect.x, x1 = rect.x + rect.width;
+	const int w0 = x0 / WORD_BITS, w1 = x1 / WORD_BITS;
+	const uint64_t before_x0 = ((uint64_t) 1 << (x0 % WORD_BITS)) - 1;
+	const uint64_t before_x1 = ((uint64_t) 1 << (x1 % WORD_BITS)) - 1;
+
+	int sum = 0;
+	for (int y = rect.y; y < rect.y + rect.height; ++y)
+	{
+		const uint64_t* words = row(y);
+		const int* counts = &_row_counts[(size_t) y * stride];
+
+		// Whole words [w0, w1), minus the bits before x0, plus the bits of word w1 before x1
+		sum += counts[w1] - counts[w0] - popcount(words[w0] & before_x0);
+		if (before_x1 != 0) sum += popcount(words[w1] & before_x1);
+	}
+	return sum;
+}
+
+} /* namespace nl_uu_science_gmt */
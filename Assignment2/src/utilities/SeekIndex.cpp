@@ -0,0 +1,211 @@
+/*
+ * SeekIndex.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SeekIndex.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "General.h"
+#include "VideoMetadata.h"
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+const uint32_t SeekIndex::MAGIC = 0x58494b53;  // "SKIX"
+const int32_t SeekIndex::VERSION = 2;  // 2: keyframe candidates, modification time
+const int SeekIndex::SEEK_INTERVAL = 25;
+
+/**
+ * Get the index of the video 'video_path' from the index file 'cache_path' if it belongs
+ * to this video, otherwise build and save it
+ */
+bool SeekIndex::obtain(const string &video_path, const string &cache_path)
+{
+	_video_path = video_path;
+	const int64_t video_bytes = General::fsize(video_path);
+	const int64_t video_time = General::fmtime(video_path);
+	if (video_bytes <= 0) return false;
+	if (load(cache_path, video_bytes, video_time)) return true;
+
+	cout << "Indexing " << video_path << "..." << flush;
+	if (!build())
+	{
+		cout << " failed!" << endl;
+		return false;
+	}
+	cout << " " << _hashes.size() << " frames, " << _points.size() << " seek points" << endl;
+
+	if (!save(cache_path, video_bytes, video_time)) cout << "Unable to write: " << cache_path << endl;
+	return true;
+}
+
+/**
+ * Decode the whole video once to hash every frame, then try a seek to each candidate
+ * position (the keyframes): it's a seek point if the two frames read after the seek are
+ * the right ones
+ */
+bool SeekIndex::build()
+{
+	VideoCapture video(_video_path);
+	if (!video.isOpened()) return false;
+
+	_hashes.clear();
+	_points.clear();
+
+	Mat frame;
+	while (video.read(frame) && !frame.empty())
+		_hashes.push_back(hashFrame(frame));
+	const int frames = (int) _hashes.size();
+
+	vector<int> candidates;
+	if (!VideoMetadata::readKeyframes(_video_path, candidates))
+	{
+		for (int k = 0; k < frames; k += SEEK_INTERVAL)
+			candidates.push_back(k);
+	}
+
+	for (size_t c = 0; c < candidates.size() && candidates[c] < frames; ++c)
+	{
+		const int k = candidates[c];
+		video.set(CV_CAP_PROP_POS_FRAMES, k);
+		bool exact = true;
+		for (int f = k; f < min(k + 2, frames) && exact; ++f)
+			exact = video.read(frame) && !frame.empty() && hashFrame(frame) == _hashes[f];
+		if (exact) _points.push_back(k);
+	}
+	return frames > 0;
+}
+
+/**
+ * The seek point a seek to 'frame' starts decoding from (0 if there's none before it)
+ */
+int SeekIndex::getSeekPoint(int frame) const
+{
+	vector<int>::const_iterator point = upper_bound(_points.begin(), _points.end(), frame);
+	return point == _points.begin() ? 0 : *(--point);
+}
+
+/**
+ * Position 'video' (of this index) so the next frame it reads is frame 'frame'
+ */
+void SeekIndex::seek(VideoCapture &video, int frame) const
+{
+	int position = getSeekPoint(frame);
+	if (_points.empty() || _points.front() > frame)
+	{
+		// No seek point before the frame (not even 0), a freshly opened video is at the start
+		video.open(_video_path);
+	}
+	else
+	{
+		video.set(CV_CAP_PROP_POS_FRAMES, position);
+	}
+
+	// Decode forward, without converting the skipped frames
+	for (; position < frame; ++position)
+		if (!video.grab()) break;
+}
+
+/**
+ * Check that 'samples' seeks to random frames land on the right frame
+ */
+bool SeekIndex::verify(int samples) const
+{
+	VideoCapture video(_video_path);
+	if (!video.isOpened() || _hashes.empty()) return false;
+
+	Mat frame;
+	for (int s = 0; s < samples; ++s)
+	{
+		const int target = rand() % (int) _hashes.size();
+		seek(video, target);
+		if (!video.read(frame) || frame.empty() || hashFrame(frame) != _hashes[target]) return false;
+	}
+	return true;
+}
+
+/**
+ * 64 bit FNV-1a hash of the frame's pixels
+ */
+uint64_t SeekIndex::hashFrame(const Mat &frame)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	const size_t row_bytes = frame.cols * frame.elemSize();
+	for (int y = 0; y < frame.rows; ++y)
+	{
+		const uchar* pixels = frame.ptr<uchar>(y);
+		for (size_t i = 0; i < row_bytes; ++i)
+			hash = (hash ^ pixels[i]) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+/**
+ * Read the index file, if it was made from a video of 'video_bytes' bytes, last modified at
+ * 'video_time', that still starts with the same frame
+ */
+bool SeekIndex::load(const string &cache_path, int64_t video_bytes, int64_t video_time)
+{
+	ifstream file(cache_path.c_str(), ios::binary);
+	if (!file.is_open()) return false;
+
+	uint32_t magic = 0;
+	int32_t version = 0, frames = 0, points = 0;
+	int64_t source_bytes = 0, source_time = 0;
+	file.read((char*) &magic, sizeof(magic));
+	file.read((char*) &version, sizeof(version));
+	file.read((char*) &source_bytes, sizeof(source_bytes));
+	file.read((char*) &source_time, sizeof(source_time));
+	file.read((char*) &frames, sizeof(frames));
+	file.read((char*) &points, sizeof(points));
+	if (!file || magic != MAGIC || version != VERSION || source_bytes != video_bytes || source_time != video_time
+			|| frames <= 0 || points < 0) return false;
+
+	_hashes.resize(frames);
+	_points.resize(points);
+	file.read((char*) &_hashes[0], frames * sizeof(uint64_t));
+	if (points > 0) file.read((char*) &_points[0], points * sizeof(int));
+
+	// A video re-encoded to the same size within the same second still differs in its first frame
+	VideoCapture video(_video_path);
+	Mat frame;
+	if (!file || !video.read(frame) || frame.empty() || hashFrame(frame) != _hashes[0])
+	{
+		_hashes.clear();
+		_points.clear();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Write the index file: a header (identifying the video by its size in bytes and its
+ * modification time), followed by the frame hashes and the seek points
+ */
+bool SeekIndex::save(const string &cache_path, int64_t video_bytes, int64_t video_time) const
+{
+	ofstream file(cache_path.c_str(), ios::binary);
+	if (!file.is_open()) return false;
+
+	const int32_t frames = (int32_t) _hashes.size(), points = (int32_t) _points.size();
+	file.write((const char*) &MAGIC, sizeof(MAGIC));
+	file.write((const char*) &VERSION, sizeof(VERSION));
+	file.write((const char*) &video_bytes, sizeof(video_bytes));
+	file.write((const char*) &video_time, sizeof(video_time));
+	file.write((const char*) &frames, sizeof(frames));
+	file.write((const char*) &points, sizeof(points));
+	file.write((const char*) &_hashes[0], frames * sizeof(uint64_t));
+	if (points > 0) file.write((const char*) &_points[0], points * sizeof(int));
+	return (bool) file;
+}
+
+} /* namespace nl_uu_science_gmt */
@@ -0,0 +1,243 @@
+/*
+ * SharedFrameRing.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "SharedFrameRing.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+const uint32_t SharedFrameRing::MAGIC = 0x474e5246;  // "FRNG"
+const int32_t SharedFrameRing::VERSION = 1;
+const size_t SharedFrameRing::HEADER_BYTES = 4096;
+const size_t SharedFrameRing::SLOT_HEADER_BYTES = 64;
+
+SharedFrameRing::SharedFrameRing() :
+		_owner(false), _data(NULL), _bytes(0), _header(NULL), _holding(false)
+{
+}
+
+SharedFrameRing::~SharedFrameRing()
+{
+	if (_owner && isOpen()) finish();
+	close();
+}
+
+/**
+ * The shared memory name of the given camera's ring
+ */
+string SharedFrameRing::getName(int camera)
+{
+	stringstream name;
+	name << "/voxel_reconstruction_cam" << (camera + 1);
+	return name.str();
+}
+
+/**
+ * The slot of the given frame sequence number
+ */
+uchar* SharedFrameRing::slot(uint64_t sequence) const
+{
+	return _data + HEADER_BYTES + (sequence % (uint64_t) _header->slots) * _header->slot_stride;
+}
+
+/**
+ * Producer: create the shared memory 'name' (replacing a stale one) for 'slots' frames of
+ * the given size
+ */
+bool SharedFrameRing::create(const string &name, const Size &size, int slots)
+{
+	close();
+	if (slots < 2 || size.area() <= 0) return false;
+
+#ifdef _WIN32
+	cerr << "Shared memory frame input not supported on Windows!" << endl;
+	return false;
+#else
+	const uint64_t stride = (SLOT_HEADER_BYTES + (uint64_t) size.area() * 3 + 63) & ~(uint64_t) 63;
+	const size_t bytes = HEADER_BYTES + (size_t) slots * stride;
+
+	shm_unlink(name.c_str());
+	const int file = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (file < 0) return false;
+	void* data = ftruncate(file, bytes) == 0 ? mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0) :
+			MAP_FAILED;
+	::close(file);  // the mapping keeps the shared memory
+	if (data == MAP_FAILED)
+	{
+		shm_unlink(name.c_str());
+		return false;
+	}
+
+	_name = name;
+	_owner = true;
+	_data = (uchar*) data;
+	_bytes = bytes;
+	_header = new (_data) Header();
+	assert(_header->tail.is_lock_free());
+	_header->version = VERSION;
+	_header->width = size.width;
+	_header->height = size.height;
+	_header->slots = slots;
+	_header->slot_stride = stride;
+	_header->head.store(0);
+	_header->tail.store(0);
+	_header->dropped.store(0);
+	_header->finished.store(0);
+
+	// A consumer only accepts the header once the magic number is there
+	atomic_thread_fence(memory_order_release);
+	_header->magic = MAGIC;
+	return true;
+#endif
+}
+
+/**
+ * Consumer: map the shared memory 'name' of a producer. False if it isn't there (yet).
+ */
+bool SharedFrameRing::open(const string &name)
+{
+	close();
+
+#ifdef _WIN32
+	cerr << "Shared memory frame input not supported on Windows!" << endl;
+	return false;
+#else
+	const int file = shm_open(name.c_str(), O_RDWR, 0);
+	if (file < 0) return false;
+	struct stat status;
+	void* data = MAP_FAILED;
+	if (fstat(file, &status) == 0 && (size_t) status.st_size >= HEADER_BYTES)
+		data = mmap(NULL, status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	::close(file);
+	if (data == MAP_FAILED) return false;
+
+	_name = name;
+	_owner = false;
+	_data = (uchar*) data;
+	_bytes = status.st_size;
+	_header = (Header*) _data;
+	_holding = false;
+
+	const bool valid = _header->magic == MAGIC && _header->version == VERSION && _header->slots >= 2
+			&& _bytes >= HEADER_BYTES + (size_t) _header->slots * _header->slot_stride;
+	atomic_thread_fence(memory_order_acquire);
+	if (!valid) close();
+	return valid;
+#endif
+}
+
+/**
+ * Unmap the ring (the producer also removes the shared memory, a consumer that still has
+ * it mapped keeps it until it closes)
+ */
+void SharedFrameRing::close()
+{
+#ifndef _WIN32
+	if (_data != NULL) munmap(_data, _bytes);
+	if (_owner) shm_unlink(_name.c_str());
+#endif
+	_owner = false;
+	_data = NULL;
+	_bytes = 0;
+	_header = NULL;
+	_holding = false;
+}
+
+/**
+ * Producer: publish 'frame' (BGR, of the ring's size) as frame 'number' taken at 'timestamp'.
+ * False if it was dropped as the consumer is a full ring behind.
+ */
+bool SharedFrameRing::write(const Mat &frame, int64_t number, double timestamp)
+{
+	assert(_owner && isOpen());
+	assert(frame.type() == CV_8UC3 && frame.size() == getSize());
+
+	const uint64_t tail = _header->tail.load(memory_order_relaxed);
+	if (tail - _header->head.load(memory_order_acquire) >= (uint64_t) _header->slots)
+	{
+		_header->dropped.fetch_add(1, memory_order_relaxed);
+		return false;
+	}
+
+	uchar* data = slot(tail);
+	Slot* info = (Slot*) data;
+	info->number = number;
+	info->timestamp = timestamp;
+	const size_t row_bytes = (size_t) frame.cols * 3;
+	for (int y = 0; y < frame.rows; ++y)
+		memcpy(data + SLOT_HEADER_BYTES + y * row_bytes, frame.ptr<uchar>(y), row_bytes);
+
+	_header->tail.store(tail + 1, memory_order_release);
+	return true;
+}
+
+/**
+ * Producer: tell the consumer no more frames will come
+ */
+void SharedFrameRing::finish()
+{
+	assert(_owner && isOpen());
+	_header->finished.store(1, memory_order_release);
+}
+
+/**
+ * Consumer: make 'frame' a header over the next frame (or the latest one, skipping the frames
+ * in between), waiting at most 'timeout' ms for it, and give its frame number and timestamp.
+ * This releases the frame of the previous read, the new one stays valid until the next read.
+ * False (and an empty frame) on a timeout or after the producer finished.
+ */
+bool SharedFrameRing::read(Mat &frame, int64_t &number, double &timestamp, int timeout, bool latest)
+{
+	assert(!_owner && isOpen());
+
+	const uint64_t head = _header->head.load(memory_order_relaxed);
+	uint64_t next = _holding ? head + 1 : head;
+	const chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::milliseconds(timeout);
+
+	uint64_t tail;
+	while ((tail = _header->tail.load(memory_order_acquire)) <= next)
+	{
+		// The producer finishes after its last frame, so check the tail once more
+		const bool finished = _header->finished.load(memory_order_acquire) != 0;
+		if ((finished && _header->tail.load(memory_order_acquire) <= next) || chrono::steady_clock::now() >= deadline)
+		{
+			frame = Mat();
+			return false;
+		}
+		this_thread::sleep_for(chrono::microseconds(200));
+	}
+	if (latest) next = tail - 1;
+
+	// Release everything before the new frame, and hold on to it
+	_header->head.store(next, memory_order_release);
+	_holding = true;
+
+	uchar* data = slot(next);
+	const Slot* info = (const Slot*) data;
+	number = info->number;
+	timestamp = info->timestamp;
+	frame = Mat(getSize(), CV_8UC3, data + SLOT_HEADER_BYTES);
+	return true;
+}
+
+} /* namespace nl_uu_science_gmt */
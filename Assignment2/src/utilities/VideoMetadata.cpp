@@ -0,0 +1,264 @@
+/*
+ * VideoMetadata.cpp
+ *
+ *  Created on: Oct 19, 2026
+ */
+
+#include "VideoMetadata.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "General.h"
+#include "SeekIndex.h"
+
+using namespace std;
+using namespace cv;
+
+namespace nl_uu_science_gmt
+{
+
+const uint32_t VideoMetadata::MAGIC = 0x4f464e49;  // "INFO"
+const int32_t VideoMetadata::VERSION = 2;  // 2: modification time, first frame
+
+/**
+ * Little endian 32 bit value at 'bytes'
+ */
+static uint32_t le32(const uchar* bytes)
+{
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+/**
+ * Hash (SeekIndex::hashFrame) of the first frame of the video 'video_path', false if it can't be decoded
+ */
+static bool hashFirstFrame(const string &video_path, uint64_t &hash)
+{
+	VideoCapture video(video_path);
+	Mat frame;
+	if (!video.read(frame) || frame.empty()) return false;
+	hash = SeekIndex::hashFrame(frame);
+	return true;
+}
+
+VideoMetadata::VideoMetadata() :
+		frames(0), fps(0)
+{
+}
+
+/**
+ * Get the metadata of the video 'video_path' from the metadata file 'cache_path' if it
+ * belongs to this video, otherwise probe the video and save them
+ */
+bool VideoMetadata::obtain(const string &video_path, const string &cache_path)
+{
+	const int64_t video_bytes = General::fsize(video_path);
+	const int64_t video_time = General::fmtime(video_path);
+	if (video_bytes <= 0) return false;
+	if (load(cache_path, video_path, video_bytes, video_time)) return true;
+	if (!probe(video_path)) return false;
+
+	uint64_t first_hash = 0;
+	if (hashFirstFrame(video_path, first_hash) && !save(cache_path, video_bytes, video_time, first_hash)) cout << "Unable to write: " << cache_path << endl;
+	return true;
+}
+
+/**
+ * Read the metadata from the AVI headers of the video. False if it isn't an AVI file or the
+ * headers don't give a frame count and resolution.
+ */
+bool VideoMetadata::probe(const string &video_path)
+{
+	frames = 0;
+	fps = 0;
+	size = Size();
+
+	ifstream file(video_path.c_str(), ios::binary);
+	if (!file.is_open()) return false;
+
+	uchar riff[12];
+	if (!file.read((char*) riff, sizeof(riff)) || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "AVI ", 4) != 0)
+		return false;
+
+	bool video_stream = false, video_seen = false;
+	walk(file, 8 + (int64_t) le32(riff + 4), video_stream, video_seen);
+	return frames > 0 && size.area() > 0;
+}
+
+/**
+ * Read the frame numbers of the keyframes of the first video stream from the AVI's legacy
+ * index (idx1, after the movie data), in ascending order. False if it isn't an AVI file or
+ * it has no such index (eg. OpenDML files only have the per-part indexes).
+ */
+bool VideoMetadata::readKeyframes(const string &video_path, vector<int> &keyframes)
+{
+	keyframes.clear();
+
+	ifstream file(video_path.c_str(), ios::binary);
+	if (!file.is_open()) return false;
+
+	uchar header[12];
+	if (!file.read((char*) header, sizeof(header)) || memcmp(header, "RIFF", 4) != 0
+			|| memcmp(header + 8, "AVI ", 4) != 0) return false;
+	const int64_t end = 8 + (int64_t) le32(header + 4);
+
+	// Skip the top level chunks (header list, movie data, junk) up to the index
+	while ((int64_t) file.tellg() + 8 <= end && file.read((char*) header, 8))
+	{
+		const uint32_t chunk_bytes = le32(header + 4);
+		if (memcmp(header, "idx1", 4) != 0)
+		{
+			file.seekg(chunk_bytes + (chunk_bytes & 1), ios::cur);
+			continue;
+		}
+
+		// AVIOLDINDEX entries: chunk id ("##dc" or "##db" for video stream ##), flags, offset, size
+		vector<uchar> index(chunk_bytes);
+		if (chunk_bytes == 0 || !file.read((char*) &index[0], chunk_bytes)) return false;
+
+		const uint32_t KEYFRAME = 0x10;  // AVIIF_KEYFRAME
+		char stream[2] = { 0, 0 };
+		int frame = 0;
+		for (size_t e = 0; e + 16 <= index.size(); e += 16)
+		{
+			const uchar* entry = &index[e];
+			if (entry[2] != 'd' || (entry[3] != 'c' && entry[3] != 'b')) continue;  // not video
+			if (stream[0] == 0)
+			{
+				stream[0] = (char) entry[0];  // the first video stream that shows up
+				stream[1] = (char) entry[1];
+			}
+			if (entry[0] != (uchar) stream[0] || entry[1] != (uchar) stream[1]) continue;
+
+			if (le32(entry + 4) & KEYFRAME) keyframes.push_back(frame);
+			++frame;
+		}
+		return !keyframes.empty();
+	}
+	return false;
+}
+
+/**
+ * Parse the chunks up to file position 'end', descending into the header lists. Stops at
+ * the movie data (false), which follows the headers. 'video_stream' tells whether the
+ * current stream list (strl) describes the first video stream, 'video_seen' whether that
+ * one has been found.
+ */
+bool VideoMetadata::walk(ifstream &file, int64_t end, bool &video_stream, bool &video_seen)
+{
+	uchar header[12];
+	while ((int64_t) file.tellg() + 8 <= end && file.read((char*) header, 8))
+	{
+		const uint32_t chunk_bytes = le32(header + 4);
+		const int64_t next = (int64_t) file.tellg() + chunk_bytes + (chunk_bytes & 1);  // word aligned
+
+		if (memcmp(header, "LIST", 4) == 0)
+		{
+			if (!file.read((char*) header + 8, 4)) return false;
+			if (memcmp(header + 8, "movi", 4) == 0) return false;
+			if (memcmp(header + 8, "strl", 4) == 0) video_stream = false;
+			if (!walk(file, next, video_stream, video_seen)) return false;
+		}
+		else
+		{
+			uchar data[40] = { 0 };
+			file.read((char*) data, min<uint32_t>(chunk_bytes, sizeof(data)));
+			if (!file) return false;
+
+			if (memcmp(header, "avih", 4) == 0 && chunk_bytes >= 40)
+			{
+				// dwMicroSecPerFrame, ..., dwTotalFrames (first RIFF part only), ..., dwWidth, dwHeight
+				if (fps == 0 && le32(data) > 0) fps = 1e6 / le32(data);
+				if (frames == 0) frames = (int) le32(data + 16);
+				if (size.area() == 0) size = Size((int) le32(data + 32), (int) le32(data + 36));
+			}
+			else if (memcmp(header, "strh", 4) == 0 && chunk_bytes >= 36)
+			{
+				// fccType, ..., dwScale, dwRate, dwStart, dwLength
+				video_stream = !video_seen && memcmp(data, "vids", 4) == 0;
+				if (video_stream)
+				{
+					video_seen = true;
+					const uint32_t scale = le32(data + 20), rate = le32(data + 24);
+					if (scale > 0 && rate > 0) fps = (double) rate / scale;
+					if (le32(data + 32) > 0) frames = (int) le32(data + 32);
+				}
+			}
+			else if (memcmp(header, "strf", 4) == 0 && video_stream && chunk_bytes >= 12)
+			{
+				// BITMAPINFOHEADER: biSize, biWidth, biHeight (negative for top-down)
+				size = Size(abs((int32_t) le32(data + 4)), abs((int32_t) le32(data + 8)));
+			}
+			else if (memcmp(header, "dmlh", 4) == 0 && chunk_bytes >= 4)
+			{
+				// dwTotalFrames of all RIFF parts
+				if (le32(data) > 0) frames = (int) le32(data);
+			}
+		}
+
+		file.clear();
+		file.seekg(next);
+	}
+	return true;
+}
+
+/**
+ * Read the metadata file, if it was made from the video 'video_path' of 'video_bytes' bytes,
+ * last modified at 'video_time', and that video still starts with the same frame
+ */
+bool VideoMetadata::load(const string &cache_path, const string &video_path, int64_t video_bytes, int64_t video_time)
+{
+	ifstream file(cache_path.c_str(), ios::binary);
+	if (!file.is_open()) return false;
+
+	uint32_t magic = 0;
+	int32_t version = 0, frames32 = 0, width = 0, height = 0;
+	int64_t source_bytes = 0, source_time = 0;
+	uint64_t source_hash = 0, first_hash = 0;
+	double rate = 0;
+	file.read((char*) &magic, sizeof(magic));
+	file.read((char*) &version, sizeof(version));
+	file.read((char*) &source_bytes, sizeof(source_bytes));
+	file.read((char*) &source_time, sizeof(source_time));
+	file.read((char*) &source_hash, sizeof(source_hash));
+	file.read((char*) &frames32, sizeof(frames32));
+	file.read((char*) &rate, sizeof(rate));
+	file.read((char*) &width, sizeof(width));
+	file.read((char*) &height, sizeof(height));
+	if (!file || magic != MAGIC || version != VERSION || source_bytes != video_bytes || source_time != video_time
+			|| frames32 <= 0 || width <= 0 || height <= 0) return false;
+
+	// A video re-encoded to the same size within the same second still differs in its first frame
+	if (!hashFirstFrame(video_path, first_hash) || first_hash != source_hash) return false;
+
+	frames = frames32;
+	fps = rate;
+	size = Size(width, height);
+	return true;
+}
+
+/**
+ * Write the metadata file: a header (identifying the video by its size in bytes, its
+ * modification time and the hash of its first frame), followed by the frame count, frame
+ * rate and resolution
+ */
+bool VideoMetadata::save(const string &cache_path, int64_t video_bytes, int64_t video_time, uint64_t first_hash) const
+{
+	ofstream file(cache_path.c_str(), ios::binary);
+	if (!file.is_open()) return false;
+
+	const int32_t frames32 = frames, width = size.width, height = size.height;
+	file.write((const char*) &MAGIC, sizeof(MAGIC));
+	file.write((const char*) &VERSION, sizeof(VERSION));
+	file.write((const char*) &video_bytes, sizeof(video_bytes));
+	file.write((const char*) &video_time, sizeof(video_time));
+	file.write((const char*) &first_hash, sizeof(first_hash));
+	file.write((const char*) &frames32, sizeof(frames32));
+	file.write((const char*) &fps, sizeof(fps));
+	file.write((const char*) &width, sizeof(width));
+	file.write((const char*) &height, sizeof(height));
+	return (bool) file;
+}
+
+} /* namespace nl_uu_science_gmt */
@@ -0,0 +1,89 @@
+/*
+ * FramePrefetcherTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Stress test of the FramePrefetcher's lock-free ring: reads a video in random runs of
+ * consecutive frames, random seeks, steps back, skips ahead and reads past the end, with
+ * several ring sizes, and checks every frame against the sequentially decoded video (by
+ * its hash).
+ * Meant to be run under the thread sanitizer as well (see CMakeLists.txt).
+ *
+ * Usage: FramePrefetcherTest [video (data/cam1/video.avi)] [reads per ring size (3000)]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+#include "FramePrefetcher.h"
+#include "General.h"
+#include "SeekIndex.h"
+
+using namespace nl_uu_science_gmt;
+using namespace std;
+using namespace cv;
+
+int main(int argc, char** argv)
+{
+	const string video_path = argc > 1 ? argv[1] : "data" + string(PATH_SEP) + "cam1" + PATH_SEP + General::VideoFile;
+	const int reads = argc > 2 ? atoi(argv[2]) : 3000;
+	const string cache_path = video_path.substr(0, video_path.find_last_of(PATH_SEP) + 1) + General::SeekIndexFile;
+
+	SeekIndex index;
+	if (!index.obtain(video_path, cache_path))
+	{
+		cerr << "Unable to index: " << video_path << endl;
+		return EXIT_FAILURE;
+	}
+
+	// The reference: the hash of every frame, decoded sequentially
+	vector<uint64_t> hashes;
+	VideoCapture video(video_path);
+	Mat frame;
+	while (video.read(frame) && !frame.empty())
+		hashes.push_back(SeekIndex::hashFrame(frame));
+	const long frames = (long) hashes.size();
+	if (frames == 0)
+	{
+		cerr << "Unable to read: " << video_path << endl;
+		return EXIT_FAILURE;
+	}
+
+	const size_t slots[] = { 0, 1, 2, 4, 8 };
+	for (size_t s = 0; s < sizeof(slots) / sizeof(slots[0]); ++s)
+	{
+		srand(1);
+		FramePrefetcher prefetcher;
+		prefetcher.start(VideoCapture(video_path), slots[s], &index);
+
+		long number = 0;
+		for (int r = 0; r < reads; ++r)
+		{
+			// Mostly the next frame, sometimes a seek anywhere (past the end too), a step back or
+			// a few frames ahead (as a live consumer drops frames)
+			const int action = rand() % 16;
+			if (action == 0)
+				number = rand() % (frames + 3);
+			else if (action == 1)
+				number = max(0L, number - 1 - rand() % 3);
+			else if (action == 2)
+				number += 1 + rand() % 8;
+
+			const bool read = prefetcher.read(number, frame);
+			const bool expected = number < frames;
+			if (read != expected || (read && SeekIndex::hashFrame(frame) != hashes[number]))
+			{
+				cerr << "Wrong frame " << number << " (read " << r << ", " << slots[s] << " slots)" << endl;
+				return EXIT_FAILURE;
+			}
+			number = number + 1 < frames + 2 ? number + 1 : 0;
+		}
+		cout << slots[s] << " slots: " << reads << " reads ok" << endl;
+	}
+	return EXIT_SUCCESS;
+}
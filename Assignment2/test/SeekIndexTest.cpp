@@ -0,0 +1,86 @@
+/*
+ * SeekIndexTest.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *
+ * Frame-accuracy test of the SeekIndex: a seek to every frame of the video must read that
+ * frame, and around every seek point (where seeks switch from decoding forward to jumping)
+ * a seek followed by consecutive reads must read consecutive frames. Frames are compared by
+ * their hash with the sequentially decoded video.
+ *
+ * Usage: SeekIndexTest [video (data/cam1/video.avi)]
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "opencv2/opencv.hpp"
+
+#include "General.h"
+#include "SeekIndex.h"
+
+using namespace nl_uu_science_gmt;
+using namespace std;
+using namespace cv;
+
+/**
+ * Seek to 'frame', then read 'reads' frames, they must be 'frame' onwards
+ */
+static bool check(const SeekIndex &index, VideoCapture &video, const vector<uint64_t> &hashes, int frame, int reads)
+{
+	index.seek(video, frame);
+	Mat image;
+	for (int f = frame; f < min(frame + reads, (int) hashes.size()); ++f)
+	{
+		if (!video.read(image) || image.empty() || SeekIndex::hashFrame(image) != hashes[f])
+		{
+			cerr << "Seek to frame " << frame << " read a wrong frame " << f << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	const string video_path = argc > 1 ? argv[1] : "data" + string(PATH_SEP) + "cam1" + PATH_SEP + General::VideoFile;
+	const string cache_path = video_path.substr(0, video_path.find_last_of(PATH_SEP) + 1) + General::SeekIndexFile;
+
+	SeekIndex index;
+	if (!index.obtain(video_path, cache_path))
+	{
+		cerr << "Unable to index: " << video_path << endl;
+		return EXIT_FAILURE;
+	}
+
+	// The reference: the hash of every frame, decoded sequentially
+	vector<uint64_t> hashes;
+	VideoCapture video(video_path);
+	Mat image;
+	while (video.read(image) && !image.empty())
+		hashes.push_back(SeekIndex::hashFrame(image));
+	if (hashes.empty() || index.getFramesAmount() != (int) hashes.size())
+	{
+		cerr << "Indexed " << index.getFramesAmount() << " frames, decoded " << hashes.size() << endl;
+		return EXIT_FAILURE;
+	}
+
+	const vector<int> &points = index.getPoints();
+	cout << hashes.size() << " frames, seek points:";
+	for (size_t p = 0; p < points.size(); ++p)
+		cout << " " << points[p];
+	cout << endl;
+
+	for (int f = 0; f < (int) hashes.size(); ++f)
+		if (!check(index, video, hashes, f, 1)) return EXIT_FAILURE;
+
+	for (size_t p = 0; p < points.size(); ++p)
+		for (int f = max(0, points[p] - 2); f <= points[p] + 2; ++f)
+			if (!check(index, video, hashes, f, 5)) return EXIT_FAILURE;
+
+	cout << "All seeks exact" << endl;
+	return EXIT_SUCCESS;
+}